@@ -0,0 +1,199 @@
+#include "BicubicInterpolation.h"
+#include <algorithm>
+
+using namespace std;
+
+/*
+* Author: gcdofree
+* Date: 2026.10.19
+* Description: 二维张量积三次样条插值（自然边界）的实现
+*	曲面在网格(i, j)内可写成 Ay*Sx(i) + By*Sx(i+1) + Cy*Sxyy(i) + Dy*Sxyy(i+1)，
+*	其中Sx为f、f_xx组成的x方向样条，Sxyy为f_yy、f_xxyy组成的x方向样条
+*/
+
+BicubicInterpolation::BicubicInterpolation()
+{
+	rows = 0;
+	cols = 0;
+}
+
+
+BicubicInterpolation::~BicubicInterpolation()
+{
+}
+
+/* 初始化插值参数
+* xi代表各列的x坐标，yi代表各行的y坐标，均须依次递增，且至少2个
+* data为格点数据，data[i][j]位于(xi[j], yi[i])
+*/
+void BicubicInterpolation::initGrid(vector<float> &xxi, vector<float> &yyi, vector<vector<float> > &data)
+{
+	rows = yyi.size();
+	cols = xxi.size();
+	xi = xxi;
+	yi = yyi;
+	values.resize(rows * cols);
+	for (int i = 0; i < rows; ++i)
+	{
+		copy(data[i].begin(), data[i].begin() + cols, values.begin() + i * cols);
+	}
+
+	//节点不变时分解结果可以复用，只有节点变化才重新分解
+	splineX.initVector(xi, xi, 0, 0, cols);
+	splineX.factorKnots();
+	splineY.initVector(yi, yi, 0, 0, rows);
+	splineY.factorKnots();
+}
+
+/* 计算各节点的二阶导数 */
+void BicubicInterpolation::calcCoefs()
+{
+	mxx.resize(rows * cols);
+	myy.resize(rows * cols);
+	mxxyy.resize(rows * cols);
+
+	//x方向：每行一次求解，行之间互不相关
+#pragma omp parallel
+	{
+		vector<float> line(cols), d2, work;
+#pragma omp for
+		for (int i = 0; i < rows; ++i)
+		{
+			copy(values.begin() + i * cols, values.begin() + (i + 1) * cols, line.begin());
+			splineX.solveDerivative2(line, d2, work);
+			copy(d2.begin(), d2.end(), mxx.begin() + i * cols);
+		}
+	}
+
+	//y方向：f和f_xx的每一列各求解一次
+#pragma omp parallel
+	{
+		vector<float> line(rows), d2, work;
+#pragma omp for
+		for (int j = 0; j < cols; ++j)
+		{
+			for (int i = 0; i < rows; ++i)
+				line[i] = values[i * cols + j];
+			splineY.solveDerivative2(line, d2, work);
+			for (int i = 0; i < rows; ++i)
+				myy[i * cols + j] = d2[i];
+
+			for (int i = 0; i < rows; ++i)
+				line[i] = mxx[i * cols + j];
+			splineY.solveDerivative2(line, d2, work);
+			for (int i = 0; i < rows; ++i)
+				mxxyy[i * cols + j] = d2[i];
+		}
+	}
+}
+
+/* 定位x所在的区间并计算权重，S = a*f[k] + b*f[k+1] + c*M[k] + d*M[k+1] */
+int BicubicInterpolation::getWeights(const vector<float> &knots, float x, float &a, float &b, float &c, float &d)
+{
+	int M = knots.size() - 1;
+	int k = upper_bound(knots.begin(), knots.end(), x) - knots.begin() - 1;
+	if (k < 0)
+		k = 0;
+	if (k > M - 1)
+		k = M - 1;
+	float h = knots[k + 1] - knots[k];
+	a = (knots[k + 1] - x) / h;
+	b = 1 - a;
+	c = (a * a * a - a) * h * h / 6;
+	d = (b * b * b - b) * h * h / 6;
+	return k;
+}
+
+/* 计算某点在样条曲面上的值，超出范围的点按最近网格的多项式外推
+* x、y为该点的坐标
+*/
+float BicubicInterpolation::evaluate(float x, float y)
+{
+	float ax, bx, cx, dx, ay, by, cy, dy;
+	int j = getWeights(xi, x, ax, bx, cx, dx);
+	int i = getWeights(yi, y, ay, by, cy, dy);
+	int p = i * cols + j,
+		q = p + cols;
+
+	float s0 = ax * values[p] + bx * values[p + 1] + cx * mxx[p] + dx * mxx[p + 1];
+	float s1 = ax * values[q] + bx * values[q + 1] + cx * mxx[q] + dx * mxx[q + 1];
+	float t0 = ax * myy[p] + bx * myy[p + 1] + cx * mxxyy[p] + dx * mxxyy[p + 1];
+	float t1 = ax * myy[q] + bx * myy[q + 1] + cx * mxxyy[q] + dx * mxxyy[q + 1];
+	return ay * s0 + by * s1 + cy * t0 + dy * t1;
+}
+
+/* 并行计算多个任意位置的点在样条曲面上的值
+* x、y为各点的坐标，个数相同
+* z返回各点的值
+*/
+void BicubicInterpolation::evaluate(const vector<float> &x, const vector<float> &y, vector<float> &z)
+{
+	int pointsNum = x.size();
+	z.resize(pointsNum);
+#pragma omp parallel for
+	for (int k = 0; k < pointsNum; ++k)
+	{
+		z[k] = evaluate(x[k], y[k]);
+	}
+}
+
+/* 把网格按整数倍加密，每个网格内均匀插入factor-1个点，原节点保持不变
+* factor为加密倍数，至少为1
+* data返回加密后的格点数据，行列数为(rows-1)*factor+1和(cols-1)*factor+1，可直接用于等值线生成
+* xo、yo返回加密后各列的x坐标、各行的y坐标
+*/
+void BicubicInterpolation::upsample(int factor, vector<vector<float> > &data, vector<float> &xo, vector<float> &yo)
+{
+	if (factor < 1)
+		factor = 1;
+	int outRows = (rows - 1) * factor + 1,
+		outCols = (cols - 1) * factor + 1;
+
+	//每个输出列（行）所在的区间和权重只计算一次，整个网格共用
+	vector<int> colCell(outCols), rowCell(outRows);
+	vector<float> colWeight(outCols * 4), rowWeight(outRows * 4);
+	xo.resize(outCols);
+	yo.resize(outRows);
+	for (int c = 0; c < outCols; ++c)
+	{
+		int j = c / factor < cols - 1 ? c / factor : cols - 2;
+		float t = (float)(c - j * factor) / factor;
+		xo[c] = c % factor == 0 ? xi[c / factor] : xi[j] + (xi[j + 1] - xi[j]) * t;
+		colCell[c] = getWeights(xi, xo[c], colWeight[c * 4], colWeight[c * 4 + 1], colWeight[c * 4 + 2], colWeight[c * 4 + 3]);
+	}
+	for (int r = 0; r < outRows; ++r)
+	{
+		int i = r / factor < rows - 1 ? r / factor : rows - 2;
+		float t = (float)(r - i * factor) / factor;
+		yo[r] = r % factor == 0 ? yi[r / factor] : yi[i] + (yi[i + 1] - yi[i]) * t;
+		rowCell[r] = getWeights(yi, yo[r], rowWeight[r * 4], rowWeight[r * 4 + 1], rowWeight[r * 4 + 2], rowWeight[r * 4 + 3]);
+	}
+
+	data.resize(outRows);
+#pragma omp parallel
+	{
+		//先在y方向合成当前输出行上各节点列的f和f_xx，再在x方向插值
+		vector<float> g(cols), gxx(cols);
+#pragma omp for
+		for (int r = 0; r < outRows; ++r)
+		{
+			int p = rowCell[r] * cols,
+				q = p + cols;
+			const float *w = &rowWeight[r * 4];
+			for (int j = 0; j < cols; ++j)
+			{
+				g[j] = w[0] * values[p + j] + w[1] * values[q + j] + w[2] * myy[p + j] + w[3] * myy[q + j];
+				gxx[j] = w[0] * mxx[p + j] + w[1] * mxx[q + j] + w[2] * mxxyy[p + j] + w[3] * mxxyy[q + j];
+			}
+
+			vector<float> &out = data[r];
+			out.resize(outCols);
+			for (int c = 0; c < outCols; ++c)
+			{
+				int j = colCell[c];
+				const float *v = &colWeight[c * 4];
+				out[c] = v[0] * g[j] + v[1] * g[j + 1] + v[2] * gxx[j] + v[3] * gxx[j + 1];
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <vector>
+#include "CubicInterpolation.h"
+
+/*
+* Author: gcdofree
+* Date: 2026.10.19
+* Description: 二维张量积三次样条插值（自然边界），用于把格点场加密到更细的网格
+*	先并行对每一行求x方向的二阶导数，再并行对每一列求y方向的二阶导数，
+*	同一方向的所有行（列）节点间距相同，三对角矩阵只分解一次
+*/
+
+class BicubicInterpolation
+{
+public:
+	BicubicInterpolation();
+	~BicubicInterpolation();
+
+	int rows, cols;
+	std::vector<float> xi, yi;//各列的x坐标、各行的y坐标
+	std::vector<float> values;//节点值，按行存储
+	std::vector<float> mxx, myy, mxxyy;//各节点的f_xx、f_yy、f_xxyy，按行存储
+
+	/* 初始化插值参数
+	* xi代表各列的x坐标，yi代表各行的y坐标，均须依次递增，且至少2个
+	* data为格点数据，data[i][j]位于(xi[j], yi[i])
+	*/
+	void initGrid(std::vector<float> &xi, std::vector<float> &yi, std::vector<std::vector<float> > &data);
+
+	/* 计算各节点的二阶导数 */
+	void calcCoefs();
+
+	/* 计算某点在样条曲面上的值，超出范围的点按最近网格的多项式外推
+	* x、y为该点的坐标
+	*/
+	float evaluate(float x, float y);
+
+	/* 并行计算多个任意位置的点在样条曲面上的值
+	* x、y为各点的坐标，个数相同
+	* z返回各点的值
+	*/
+	void evaluate(const std::vector<float> &x, const std::vector<float> &y, std::vector<float> &z);
+
+	/* 把网格按整数倍加密，每个网格内均匀插入factor-1个点，原节点保持不变
+	* factor为加密倍数，至少为1
+	* data返回加密后的格点数据，行列数为(rows-1)*factor+1和(cols-1)*factor+1，可直接用于等值线生成
+	* xo、yo返回加密后各列的x坐标、各行的y坐标
+	*/
+	void upsample(int factor, std::vector<std::vector<float> > &data, std::vector<float> &xo, std::vector<float> &yo);
+
+private:
+	CubicInterpolation splineX, splineY;//只用于保存x、y方向分解好的三对角矩阵
+
+	/* 定位x所在的区间并计算权重，S = a*f[k] + b*f[k+1] + c*M[k] + d*M[k+1] */
+	static int getWeights(const std::vector<float> &knots, float x, float &a, float &b, float &c, float &d);
+};
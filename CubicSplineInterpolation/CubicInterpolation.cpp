@@ -1,5 +1,9 @@
 #include "CubicInterpolation.h"
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
 
 /*
 * Author: gcdofree
@@ -7,11 +11,196 @@
 * Description: 三次样条插值的实现
 */
 
-CubicInterpolation::CubicInterpolation()
+/* 第k个区间的多项式在x处的值 */
+static inline float evaluateCell(const SplineView &s, int k, float x)
+{
+	const float *c = s.coefs + k * 4;
+	float dx = x - s.xi[k];
+	return ((c[3] * dx + c[2]) * dx + c[1]) * dx + c[0];
+}
+
+/* 超出范围的点的值，Policy为SplineOutOfRange中的一种，编译期确定 */
+template <int Policy>
+static inline float evaluateOutside(const SplineView &s, float x)
+{
+	int M = s.size - 1;
+	bool isLeft = x < s.xi[0];
+	if (Policy == SPLINE_OUT_CLAMP)
+	{
+		return isLeft ? s.yi[0] : s.yi[M];
+	}
+	else if (Policy == SPLINE_OUT_LINEAR)
+	{
+		if (isLeft)
+			return s.yi[0] + s.coefs[1] * (x - s.xi[0]);
+		const float *c = s.coefs + (M - 1) * 4;
+		float h = s.xi[M] - s.xi[M - 1];
+		return s.yi[M] + ((3 * c[3] * h + 2 * c[2]) * h + c[1]) * (x - s.xi[M]);
+	}
+	else if (Policy == SPLINE_OUT_NAN)
+	{
+		return numeric_limits<float>::quiet_NaN();
+	}
+	else if (Policy == SPLINE_OUT_FLAG)
+	{
+		return 0;
+	}
+	return evaluateCell(s, isLeft ? 0 : M - 1, x);
+}
+
+/* 单点计算：二分查找区间 */
+template <int Policy>
+static float evaluatePoint(const SplineView &s, float x)
+{
+	int M = s.size - 1;
+	if (M < 1)
+	{
+		return Policy == SPLINE_OUT_NAN ? numeric_limits<float>::quiet_NaN() : 0;
+	}
+	if (x < s.xi[0] || x > s.xi[M])
+	{
+		return evaluateOutside<Policy>(s, x);
+	}
+	int k = upper_bound(s.xi, s.xi + s.size, x) - s.xi - 1;
+	if (k > M - 1)
+		k = M - 1;
+	return evaluateCell(s, k, x);
+}
+
+/* 批量计算：第一个点用二分查找定位区间，之后只向后移动 */
+template <int Policy>
+static int evaluateBatch(const SplineView &s, const vector<float> &x, vector<float> &y)
+{
+	int M = s.size - 1,
+		xSize = x.size();
+	y.resize(xSize);
+	if (xSize == 0 || M < 1)
+	{
+		return 0;
+	}
+
+	float xFirst = s.xi[0],
+		xLast = s.xi[M];
+	int outNum = 0;
+	//第一个点正好在最后一个节点上或为NaN时upper_bound返回末尾，与evaluatePoint一样限制在最后一个区间
+	int k = upper_bound(s.xi, s.xi + s.size, x[0]) - s.xi - 1;
+	if (k < 0)
+		k = 0;
+	if (k > M - 1)
+		k = M - 1;
+	for (int i = 0; i < xSize; ++i)
+	{
+		if (x[i] < xFirst || x[i] > xLast)
+		{
+			++outNum;
+			y[i] = evaluateOutside<Policy>(s, x[i]);
+			continue;
+		}
+		while (k < M - 1 && x[i] > s.xi[k + 1])
+			++k;
+		y[i] = evaluateCell(s, k, x[i]);
+	}
+	return outNum;
+}
+
+/* 按超出范围的处理方式选择计算函数，返回实际采用的方式（未知的方式按SPLINE_OUT_CUBIC处理） */
+static int selectKernels(int outOfRange, SplinePointKernel &pointKernel, SplineBatchKernel &batchKernel)
+{
+	switch (outOfRange)
+	{
+	case SPLINE_OUT_CLAMP:
+		pointKernel = evaluatePoint<SPLINE_OUT_CLAMP>;
+		batchKernel = evaluateBatch<SPLINE_OUT_CLAMP>;
+		return outOfRange;
+	case SPLINE_OUT_LINEAR:
+		pointKernel = evaluatePoint<SPLINE_OUT_LINEAR>;
+		batchKernel = evaluateBatch<SPLINE_OUT_LINEAR>;
+		return outOfRange;
+	case SPLINE_OUT_NAN:
+		pointKernel = evaluatePoint<SPLINE_OUT_NAN>;
+		batchKernel = evaluateBatch<SPLINE_OUT_NAN>;
+		return outOfRange;
+	case SPLINE_OUT_FLAG:
+		pointKernel = evaluatePoint<SPLINE_OUT_FLAG>;
+		batchKernel = evaluateBatch<SPLINE_OUT_FLAG>;
+		return outOfRange;
+	default:
+		pointKernel = evaluatePoint<SPLINE_OUT_CUBIC>;
+		batchKernel = evaluateBatch<SPLINE_OUT_CUBIC>;
+		return SPLINE_OUT_CUBIC;
+	}
+}
+
+/* 批量计算多个点的一阶或二阶导数，超出范围的点按最近区间的多项式外推 */
+static void evaluateDerivativeView(const SplineView &s, const vector<float> &x, vector<float> &dy, int order)
+{
+	int M = s.size - 1,
+		xSize = x.size();
+	dy.resize(xSize);
+	if (xSize == 0 || M < 1)
+	{
+		return;
+	}
+
+	//超出右端的点（或NaN）由最后一个区间外推
+	int k = upper_bound(s.xi, s.xi + s.size, x[0]) - s.xi - 1;
+	if (k < 0)
+		k = 0;
+	if (k > M - 1)
+		k = M - 1;
+	for (int i = 0; i < xSize; ++i)
+	{
+		while (k < M - 1 && x[i] > s.xi[k + 1])
+			++k;
+		const float *c = s.coefs + k * 4;
+		float dx = x[i] - s.xi[k];
+		if (order == 2)
+			dy[i] = 6 * c[3] * dx + 2 * c[2];
+		else
+			dy[i] = (3 * c[3] * dx + 2 * c[2]) * dx + c[1];
+	}
+}
+
+/* 从xi[0]到x的积分，由区间积分的前缀和加上所在区间的部分积分得到 */
+static double integrateFromStart(const SplineView &s, float x)
+{
+	int M = s.size - 1;
+	int k = upper_bound(s.xi, s.xi + s.size, x) - s.xi - 1;
+	if (k < 0)
+		k = 0;
+	if (k > M - 1)
+		k = M - 1;
+	const float *c = s.coefs + k * 4;
+	double dx = x - s.xi[k];
+	return s.integralPrefix[k]
+		+ (((c[3] / 4 * dx + c[2] / 3) * dx + c[1] / 2) * dx + c[0]) * dx;
+}
+
+/* 计算[a, b]上的定积分 */
+static float integrateView(const SplineView &s, float a, float b)
+{
+	if (s.size < 2)
+	{
+		return 0;
+	}
+	return (float)(integrateFromStart(s, b) - integrateFromStart(s, a));
+}
+
+CubicInterpolation::CubicInterpolation(int outOfRangeType)
 {
 	Ml = 0;
 	Mr = 0;
+	Dl = 0;
+	Dr = 0;
+	boundaryType = SPLINE_NATURAL;
+	method = SPLINE_CUBIC;
 	originSize = 0;
+	isFactored = false;
+	cyclicCorner = 0;
+	cyclicGamma = 0;
+	cyclicFactor = 1;
+
+	outOfRange = selectKernels(outOfRangeType, pointKernel, batchKernel);
 }
 
 
@@ -40,6 +229,84 @@ void CubicInterpolation::initVector(vector<float> &xxi, vector<float> &yyi, floa
 	originSize = oSize;
 	this->Ml = ml;
 	this->Mr = mr;
+	isFactored = false;//节点变化后需要重新分解
+}
+
+/* 设置边界条件，需在calcCoefs之前调用
+* type为SplineBoundary中的一种
+* left、right在SPLINE_NATURAL时为两端的二阶导数，在SPLINE_CLAMPED时为两端的一阶导数，SPLINE_PERIODIC时忽略
+*/
+void CubicInterpolation::setBoundary(int type, float left, float right)
+{
+	boundaryType = type;
+	if (type == SPLINE_NATURAL)
+	{
+		Ml = left;
+		Mr = right;
+	}
+	else if (type == SPLINE_CLAMPED)
+	{
+		Dl = left;
+		Dr = right;
+	}
+	isFactored = false;
+}
+
+/* 设置插值方法，需在calcCoefs之前调用
+* type为SplineMethod中的一种，SPLINE_PCHIP和SPLINE_AKIMA只使用相邻节点计算斜率，边界条件不起作用
+*/
+void CubicInterpolation::setMethod(int type)
+{
+	method = type;
+}
+
+/* 只修改一个节点的y坐标并更新系数
+* SPLINE_PCHIP和SPLINE_AKIMA只重新计算该节点附近的几个区间，SPLINE_CUBIC需要重新求解
+* k为节点的序号，y为新的y坐标
+*/
+void CubicInterpolation::updateKnot(int k, float y)
+{
+	yi[k] = y;
+	if (method == SPLINE_CUBIC || (int)slopes.size() != originSize)
+	{
+		calcCoefs();
+		return;
+	}
+
+	//节点k的y坐标影响k-1、k两个区间的斜率，进而影响k-2到k+2节点的导数
+	int M = originSize - 1;
+	int nodeBegin = max(k - 2, 0),
+		nodeEnd = min(k + 2, M);
+	for (int i = nodeBegin; i <= nodeEnd; ++i)
+		slopes[i] = localSlope(i);
+	int cellBegin = max(nodeBegin - 1, 0),
+		cellEnd = min(nodeEnd, M - 1);
+	for (int i = cellBegin; i <= cellEnd; ++i)
+		setHermiteCoefs(i);
+	calcIntegralPrefix(cellBegin);
+}
+
+/* 节点的x坐标不变、只有y坐标变化时重新计算系数，复用已分解的三对角矩阵
+* yi代表所有节点新的y坐标，个数与原来相同
+* 个数不足，或SPLINE_PERIODIC时首尾的y不相同，返回false且不修改原来的样条
+*/
+bool CubicInterpolation::refitY(vector<float> &yyi)
+{
+	if ((int)yyi.size() < originSize || originSize < 1)
+	{
+		return false;
+	}
+	//周期样条的循环方程组假定首尾节点的y相同
+	if (boundaryType == SPLINE_PERIODIC && method == SPLINE_CUBIC && yyi[0] != yyi[originSize - 1])
+	{
+		return false;
+	}
+	for (int i = 0; i < originSize; ++i)
+	{
+		yi[i] = yyi[i];
+	}
+	calcCoefs();
+	return true;
 }
 
 /* 计算各种矩阵系数 */
@@ -48,6 +315,21 @@ void CubicInterpolation::calcCoefs()
 	int N = originSize,
 		M = N - 1;
 
+	//局部方法各节点互不依赖，直接并行计算导数和系数
+	if (method != SPLINE_CUBIC)
+	{
+		slopes.resize(N);
+		coefs.resize(M * 4);
+#pragma omp parallel for if (N > 4096)
+		for (int i = 0; i < N; ++i)
+			slopes[i] = localSlope(i);
+#pragma omp parallel for if (N > 4096)
+		for (int i = 0; i < M; ++i)
+			setHermiteCoefs(i);
+		calcIntegralPrefix(0);
+		return;
+	}
+
 	vector<float> m(N),
 		h(M),
 		d(M);
@@ -62,86 +344,455 @@ void CubicInterpolation::calcCoefs()
 
 	derivative2(h, d, m);
 
-	coefs.resize(M);
+	coefs.resize(M * 4);
 	for (int i = 0; i < M; ++i)
 	{
-		coefs[i].resize(4);
- 		coefs[i][0] = yi[i];
-		coefs[i][1] = d[i] - h[i] * (2 * m[i] + m[i + 1]) / 6;
-		coefs[i][2] = m[i] / 2;
-		coefs[i][3] = (m[i + 1] - m[i]) / (6 * h[i]);
+		float *c = &coefs[i * 4];
+		c[0] = yi[i];
+		c[1] = d[i] - h[i] * (2 * m[i] + m[i + 1]) / 6;
+		c[2] = m[i] / 2;
+		c[3] = (m[i + 1] - m[i]) / (6 * h[i]);
+	}
+
+	calcIntegralPrefix(0);
+}
+
+/* 局部方法中第i个节点的一阶导数，只用到相邻节点 */
+float CubicInterpolation::localSlope(int i) const
+{
+	int M = originSize - 1;
+	if (M < 2)
+	{
+		return (yi[1] - yi[0]) / (xi[1] - xi[0]);
+	}
+
+	if (method == SPLINE_PCHIP)
+	{
+		//端点用三点公式，并限制斜率保持单调
+		if (i == 0 || i == M)
+		{
+			int k0 = i == 0 ? 0 : M - 1,
+				k1 = i == 0 ? 1 : M - 2;
+			float h0 = xi[k0 + 1] - xi[k0],
+				h1 = xi[k1 + 1] - xi[k1];
+			float d0 = (yi[k0 + 1] - yi[k0]) / h0,
+				d1 = (yi[k1 + 1] - yi[k1]) / h1;
+			float s = ((2 * h0 + h1) * d0 - h0 * d1) / (h0 + h1);
+			if (s * d0 <= 0)
+				s = 0;
+			else if (d0 * d1 < 0 && fabs(s) > fabs(3 * d0))
+				s = 3 * d0;
+			return s;
+		}
+		//内部节点用两侧斜率的加权调和平均，两侧斜率异号或为0时取0
+		float h0 = xi[i] - xi[i - 1],
+			h1 = xi[i + 1] - xi[i];
+		float d0 = (yi[i] - yi[i - 1]) / h0,
+			d1 = (yi[i + 1] - yi[i]) / h1;
+		if (d0 * d1 <= 0)
+			return 0;
+		float w0 = 2 * h1 + h0,
+			w1 = h1 + 2 * h0;
+		return (w0 + w1) / (w0 / d0 + w1 / d1);
+	}
+
+	//Akima：需要i-2到i+1四个区间的斜率，超出范围的区间按抛物线外推
+	float d[4];
+	for (int k = 0; k < 4; ++k)
+	{
+		int cell = i - 2 + k;
+		if (cell < 0)
+		{
+			float e0 = (yi[1] - yi[0]) / (xi[1] - xi[0]),
+				e1 = (yi[2] - yi[1]) / (xi[2] - xi[1]);
+			d[k] = e0 + (e0 - e1) * (-cell);
+		}
+		else if (cell > M - 1)
+		{
+			float e0 = (yi[M] - yi[M - 1]) / (xi[M] - xi[M - 1]),
+				e1 = (yi[M - 1] - yi[M - 2]) / (xi[M - 1] - xi[M - 2]);
+			d[k] = e0 + (e0 - e1) * (cell - M + 1);
+		}
+		else
+		{
+			d[k] = (yi[cell + 1] - yi[cell]) / (xi[cell + 1] - xi[cell]);
+		}
+	}
+	float w0 = fabs(d[3] - d[2]),
+		w1 = fabs(d[1] - d[0]);
+	if (w0 + w1 == 0)
+		return (d[1] + d[2]) / 2;
+	return (w0 * d[1] + w1 * d[2]) / (w0 + w1);
+}
+
+/* 由两端节点的一阶导数计算第i个区间的Hermite多项式系数 */
+void CubicInterpolation::setHermiteCoefs(int i)
+{
+	float h = xi[i + 1] - xi[i],
+		d = (yi[i + 1] - yi[i]) / h;
+	float *c = &coefs[i * 4];
+	c[0] = yi[i];
+	c[1] = slopes[i];
+	c[2] = (3 * d - 2 * slopes[i] - slopes[i + 1]) / h;
+	c[3] = (slopes[i] + slopes[i + 1] - 2 * d) / (h * h);
+}
+
+/* 从第from个区间开始重新计算积分的前缀和 */
+void CubicInterpolation::calcIntegralPrefix(int from)
+{
+	//各区间多项式的积分累加成前缀和，定积分只需查两次前缀和
+	int M = originSize - 1;
+	integralPrefix.resize(originSize);
+	integralPrefix[0] = 0;
+	for (int i = from; i < M; ++i)
+	{
+		const float *c = &coefs[i * 4];
+		float h = xi[i + 1] - xi[i];
+		integralPrefix[i + 1] = integralPrefix[i]
+			+ (((c[3] / 4 * h + c[2] / 3) * h + c[1] / 2) * h + c[0]) * h;
 	}
 }
 
-/* 计算某点在三次样条曲线上的坐标
+/* 计算某点在三次样条曲线上的坐标，超出范围的点按构造时指定的方式处理
 * x为该点的x坐标
 */
 float CubicInterpolation::evaluate(float x)
 {
-	int k = -1,
-		N = originSize,
-		M = N - 1;
+	return pointKernel(getView(), x);
+}
 
-	float dx,
-		y;
+/* 批量计算多个点在三次样条曲线上的坐标
+* x为各点的x坐标，必须依次递增
+* y返回各点的y坐标，超出范围的点按构造时指定的方式处理
+* 返回超出范围的点数
+*/
+int CubicInterpolation::evaluate(const vector<float> &x, vector<float> &y)
+{
+	return batchKernel(getView(), x, y);
+}
 
-	for (int i = 0; i < M; ++i)
+/* 批量计算多个点的一阶或二阶导数，直接对区间多项式求导
+* x为各点的x坐标，必须依次递增
+* dy返回各点的导数，超出范围的点按最近区间的多项式外推
+* order为导数的阶数，1或2
+*/
+void CubicInterpolation::evaluateDerivative(const vector<float> &x, vector<float> &dy, int order)
+{
+	evaluateDerivativeView(getView(), x, dy, order);
+}
+
+/* 计算[a, b]上的定积分，a大于b时结果为负，超出范围的部分按最近区间的多项式外推 */
+float CubicInterpolation::integrate(float a, float b)
+{
+	return integrateView(getView(), a, b);
+}
+
+/* 批量计算多个区间的定积分，每个区间用二分查找定位，与节点数成对数关系
+* a、b为各区间的起点和终点，个数相同
+* s返回各区间的积分
+*/
+void CubicInterpolation::integrate(const vector<float> &a, const vector<float> &b, vector<float> &s)
+{
+	int queryNum = a.size();
+	s.resize(queryNum);
+	for (int i = 0; i < queryNum; ++i)
 	{
-		if ((xi[i] <= x) && (xi[i + 1] >= x))
+		s[i] = integrate(a[i], b[i]);
+	}
+}
+
+/* 当前节点和系数的只读视图 */
+SplineView CubicInterpolation::getView() const
+{
+	SplineView view;
+	view.xi = xi.data();
+	view.yi = yi.data();
+	view.coefs = coefs.data();
+	view.integralPrefix = integralPrefix.data();
+	view.size = originSize;
+	return view;
+}
+
+/* 由当前的节点和系数生成不可修改的样条，需在calcCoefs之后调用
+* 之后再修改本对象或重新拟合都不影响已生成的样条
+*/
+shared_ptr<const FittedSpline> CubicInterpolation::fit() const
+{
+	return make_shared<FittedSpline>(xi, yi, coefs, integralPrefix, originSize, outOfRange);
+}
+
+/* 用LU分解后的三对角矩阵求解，v为右端项，结果写回v */
+static void solveTridiagonal(const vector<float> &lower, const vector<float> &pivot, const vector<float> &upper, float *v)
+{
+	int n = pivot.size();
+	for (int i = 1; i < n; ++i)
+		v[i] -= lower[i] * v[i - 1];
+
+	v[n - 1] /= pivot[n - 1];
+	for (int i = n - 2; i >= 0; --i)
+		v[i] = (v[i] - upper[i] * v[i + 1]) / pivot[i];
+}
+
+/* 按当前的节点和边界类型分解三对角矩阵
+* SPLINE_NATURAL：未知量为内部节点的二阶导数
+* SPLINE_CLAMPED：未知量为所有节点的二阶导数，首尾两行由一阶导数给出
+* SPLINE_PERIODIC：未知量为前N-1个节点的二阶导数，循环三对角矩阵用Sherman–Morrison公式化为普通三对角矩阵
+*/
+void CubicInterpolation::factorize(vector<float> &dx)
+{
+	int M = originSize - 1,
+		n = 0;
+	vector<float> a, b, c;//下对角线、主对角线、上对角线
+
+	if (boundaryType == SPLINE_CLAMPED)
+	{
+		n = M + 1;
+		a.resize(n);
+		b.resize(n);
+		c.resize(n);
+		b[0] = 2 * dx[0];
+		c[0] = dx[0];
+		for (int i = 1; i < M; ++i)
 		{
-			k = i;
-			dx = x - xi[i];
-			break;
+			a[i] = dx[i - 1];
+			b[i] = 2 * (dx[i - 1] + dx[i]);
+			c[i] = dx[i];
 		}
+		a[M] = dx[M - 1];
+		b[M] = 2 * dx[M - 1];
 	}
-	if (k != -1)
+	else if (boundaryType == SPLINE_PERIODIC)
 	{
-		y = ((coefs[k][3] * dx + coefs[k][2]) * dx + coefs[k][1]) * dx
-			+ coefs[k][0];
-		return y;
+		n = M;
+		a.resize(n);
+		b.resize(n);
+		c.resize(n);
+		for (int i = 0; i < n; ++i)
+		{
+			float prev = dx[(i - 1 + M) % M];
+			a[i] = prev;
+			b[i] = 2 * (prev + dx[i]);
+			c[i] = dx[i];
+		}
+		if (n == 1)
+		{
+			b[0] += a[0] + c[0];//前后两个节点都是自身
+		}
+		else if (n == 2)
+		{
+			c[0] += a[0];//前后两个节点是同一个
+			a[1] += c[1];
+		}
 	}
 	else
 	{
-		cout << "The x value is out of range!" << endl;
-		return float(0);
+		n = M - 1;
+		a.resize(n > 0 ? n : 0);
+		b.resize(n > 0 ? n : 0);
+		c.resize(n > 0 ? n : 0);
+		for (int k = 0; k < n; ++k)
+		{
+			a[k] = dx[k];
+			b[k] = 2 * (dx[k] + dx[k + 1]);
+			c[k] = dx[k + 1];
+		}
+	}
+
+	//循环三对角矩阵的两个角元素都是dx[M-1]，修改首尾主元后按普通三对角矩阵分解
+	bool isCyclic = boundaryType == SPLINE_PERIODIC && n >= 3;
+	if (isCyclic)
+	{
+		cyclicCorner = dx[M - 1];
+		cyclicGamma = -b[0];
+		b[0] -= cyclicGamma;
+		b[n - 1] -= cyclicCorner * cyclicCorner / cyclicGamma;
+	}
+
+	lower.resize(n > 0 ? n : 0);
+	pivot.resize(n > 0 ? n : 0);
+	upper.resize(n > 0 ? n : 0);
+	for (int i = 0; i < n; ++i)
+	{
+		lower[i] = i > 0 ? a[i] / pivot[i - 1] : 0;
+		pivot[i] = b[i] - (i > 0 ? lower[i] * c[i - 1] : 0);
+		upper[i] = c[i];
+	}
+
+	cyclicZ.clear();
+	if (isCyclic)
+	{
+		cyclicZ.assign(n, 0);
+		cyclicZ[0] = cyclicGamma;
+		cyclicZ[n - 1] = cyclicCorner;
+		solveTridiagonal(lower, pivot, upper, &cyclicZ[0]);
+		cyclicFactor = 1 + cyclicZ[0] + cyclicCorner / cyclicGamma * cyclicZ[n - 1];
+	}
+	knotDx = dx;
+	isFactored = true;
+}
+
+/* 按当前的节点和边界类型分解三对角矩阵，之后可用solveDerivative2求解 */
+void CubicInterpolation::factorKnots()
+{
+	int M = originSize - 1;
+	vector<float> dx(M);
+	for (int i = 0; i < M; ++i)
+		dx[i] = xi[i + 1] - xi[i];
+	factorize(dx);
+}
+
+/* 用分解好的三对角矩阵求解，v为右端项，结果写回v */
+void CubicInterpolation::solveFactored(float *v) const
+{
+	int n = pivot.size();
+	if (n == 0)
+		return;
+	solveTridiagonal(lower, pivot, upper, v);
+	if (!cyclicZ.empty())
+	{
+		float f = (v[0] + cyclicCorner / cyclicGamma * v[n - 1]) / cyclicFactor;
+		for (int i = 0; i < n; ++i)
+			v[i] -= f * cyclicZ[i];
 	}
 }
 
-/* 计算2阶导数 */
+/* 计算2阶导数
+* dx为各区间的长度，d1为各区间的斜率
+* d2返回各节点的二阶导数，SPLINE_NATURAL时d2[0]和d2[N-1]为给定值
+*/
 void CubicInterpolation::derivative2(vector<float> &dx, vector<float> &d1, vector<float> &d2)
+{
+	if (!isFactored)
+		factorize(dx);
+
+	vector<float> v(originSize);
+	solveMoments(&d1[0], &v[0], d2);
+}
+
+/* 节点的x坐标不变时，只求给定y坐标对应的各节点二阶导数，不修改本样条的系数
+* 需先调用factorKnots或calcCoefs，之后可在多个线程中同时调用
+* y为所有节点的y坐标，d2返回各节点的二阶导数，work为调用者提供的临时内存
+*/
+void CubicInterpolation::solveDerivative2(const vector<float> &y, vector<float> &d2, vector<float> &work) const
 {
 	int N = originSize,
 		M = N - 1;
-	vector<float> b(M),
-		v(M),
-		y(M),
-		alpha(M),
-		beta(M - 1);
-
-	for (int i = 1; i < M; ++i)
-		b[i] = 2 * (dx[i] + dx[i - 1]);
-
-	v[1] = 6 * (d1[1] - d1[0]) - dx[0] * d2[0];
-	for (int i = 1; i < M - 1; ++i)
-		v[i] = 6 * (d1[i] - d1[i - 1]);
-		
-	v[M - 1] = 6 * (d1[M - 1] - d1[M - 2]) - dx[M - 1] * d2[M];
-
-	alpha[1] = b[1];
-	for (int i = 2; i < M; ++i)
-		alpha[i] = b[i] - dx[i] * dx[i - 1] / alpha[i - 1];
-		
-
-	for (int i = 1; i < M - 1; ++i)
-		beta[i] = dx[i] / alpha[i];
-		
-
-	y[1] = v[1] / alpha[1];
-	for (int i = 2; i<M; ++i)
-		y[i] = (v[i] - dx[i] * y[i - 1]) / alpha[i];
-		
-
-	d2[M - 1] = y[M - 1];
-	for (int i = M - 2; i>0; --i)
-		d2[i] = y[i] - beta[i] * d2[i + 1];
+	work.resize(2 * N);
+	d2.resize(N);
+	float *d1 = &work[0];
+	for (int i = 0; i < M; ++i)
+		d1[i] = (y[i + 1] - y[i]) / knotDx[i];
+	d2[0] = Ml;
+	d2[M] = Mr;
+	solveMoments(d1, &work[N], d2);
+}
+
+/* 由各区间的斜率d1构造右端项v并求解，结果写入d2 */
+void CubicInterpolation::solveMoments(const float *d1, float *v, vector<float> &d2) const
+{
+	int N = originSize,
+		M = N - 1;
+	const vector<float> &dx = knotDx;
+
+	if (boundaryType == SPLINE_CLAMPED)
+	{
+		v[0] = 6 * (d1[0] - Dl);
+		for (int i = 1; i < M; ++i)
+			v[i] = 6 * (d1[i] - d1[i - 1]);
+		v[M] = 6 * (Dr - d1[M - 1]);
+		solveFactored(v);
+		for (int i = 0; i < N; ++i)
+			d2[i] = v[i];
+	}
+	else if (boundaryType == SPLINE_PERIODIC)
+	{
+		for (int i = 0; i < M; ++i)
+			v[i] = 6 * (d1[i] - d1[(i - 1 + M) % M]);
+		solveFactored(v);
+		for (int i = 0; i < M; ++i)
+			d2[i] = v[i];
+		d2[M] = d2[0];
+	}
+	else
+	{
+		if (M < 2)
+			return;
+		//已知两端的二阶导数移到右端；只有一个内部节点时两端都作用在同一行
+		for (int i = 1; i < M; ++i)
+			v[i - 1] = 6 * (d1[i] - d1[i - 1]);
+		v[0] -= dx[0] * d2[0];
+		v[M - 2] -= dx[M - 1] * d2[M];
+		solveFactored(v);
+		for (int i = 1; i < M; ++i)
+			d2[i] = v[i - 1];
+	}
+}
+
+FittedSpline::FittedSpline(const vector<float> &xxi, const vector<float> &yyi, const vector<float> &ccoefs,
+	const vector<double> &prefix, int size, int outOfRangeType)
+	: xi(xxi.begin(), xxi.begin() + size), yi(yyi.begin(), yyi.begin() + size), coefs(ccoefs), integralPrefix(prefix)
+{
+	view.xi = xi.data();
+	view.yi = yi.data();
+	view.coefs = coefs.data();
+	view.integralPrefix = integralPrefix.data();
+	view.size = size;
+	selectKernels(outOfRangeType, pointKernel, batchKernel);
+}
+
+/* 节点个数 */
+int FittedSpline::getSize() const
+{
+	return view.size;
+}
+
+float FittedSpline::evaluate(float x) const
+{
+	return pointKernel(view, x);
+}
+
+int FittedSpline::evaluate(const vector<float> &x, vector<float> &y) const
+{
+	return batchKernel(view, x, y);
+}
+
+void FittedSpline::evaluateDerivative(const vector<float> &x, vector<float> &dy, int order) const
+{
+	evaluateDerivativeView(view, x, dy, order);
+}
+
+float FittedSpline::integrate(float a, float b) const
+{
+	return integrateView(view, a, b);
+}
+
+void FittedSpline::integrate(const vector<float> &a, const vector<float> &b, vector<float> &s) const
+{
+	int queryNum = a.size();
+	s.resize(queryNum);
+	for (int i = 0; i < queryNum; ++i)
+	{
+		s[i] = integrateView(view, a[i], b[i]);
+	}
+}
+
+SharedSpline::SharedSpline()
+{
+}
+
+SharedSpline::SharedSpline(shared_ptr<const FittedSpline> spline)
+	: current(spline)
+{
+}
+
+/* 取得当前的样条，可在多个线程中同时调用 */
+shared_ptr<const FittedSpline> SharedSpline::load() const
+{
+	return atomic_load(&current);
+}
+
+/* 替换为新的样条，可与load同时调用 */
+void SharedSpline::publish(shared_ptr<const FittedSpline> spline)
+{
+	atomic_store(&current, spline);
 }
\ No newline at end of file
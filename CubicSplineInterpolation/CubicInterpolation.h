@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <vector>
+#include <memory>
 
 /*
 * Author: gcdofree
@@ -7,16 +8,62 @@
 * Description: 三次样条插值的实现
 */
 
+/* 边界条件 */
+enum SplineBoundary
+{
+	SPLINE_NATURAL = 0,//给定两端的二阶导数Ml、Mr（均为0时为自然样条）
+	SPLINE_CLAMPED = 1,//给定两端的一阶导数Dl、Dr
+	SPLINE_PERIODIC = 2//周期样条，要求首尾节点的y相同
+};
+
+/* 插值方法 */
+enum SplineMethod
+{
+	SPLINE_CUBIC = 0,//三次样条，需要求解全局的三对角矩阵
+	SPLINE_PCHIP = 1,//保形分段三次Hermite插值，单调数据的插值结果也单调，不会过冲
+	SPLINE_AKIMA = 2//Akima插值，斜率由相邻的4个区间决定，对孤立的异常值不敏感
+};
+
+/* 超出节点范围的点的处理方式 */
+enum SplineOutOfRange
+{
+	SPLINE_OUT_CUBIC = 0,//按最近区间的多项式外推
+	SPLINE_OUT_CLAMP = 1,//取最近端点的值
+	SPLINE_OUT_LINEAR = 2,//按端点的切线外推
+	SPLINE_OUT_NAN = 3,//返回NaN
+	SPLINE_OUT_FLAG = 4//返回0，由批量计算的返回值报告超出范围的点数
+};
+
+/* 样条数据的只读视图，CubicInterpolation和FittedSpline共用同一套计算函数 */
+struct SplineView
+{
+	const float *xi;//节点的x坐标
+	const float *yi;//节点的y坐标
+	const float *coefs;//每个区间4个系数，连续存储
+	const double *integralPrefix;//xi[0]到各节点的积分
+	int size;//节点个数
+};
+
+typedef float (*SplinePointKernel)(const SplineView &spline, float x);
+typedef int (*SplineBatchKernel)(const SplineView &spline, const std::vector<float> &x, std::vector<float> &y);
+
+class FittedSpline;
+
 class CubicInterpolation
 {
 public:
-	CubicInterpolation();
+	/* outOfRange为SplineOutOfRange中的一种，构造时确定，编译为对应的计算函数 */
+	explicit CubicInterpolation(int outOfRange = SPLINE_OUT_CUBIC);
 	~CubicInterpolation();
 
 	float Ml, Mr;
+	float Dl, Dr;
+	int boundaryType;
+	int method;
 	int originSize;
 	std::vector<float> xi, yi;
-	std::vector<std::vector<float>> coefs;
+	std::vector<float> coefs;//第i个区间的系数为coefs[4*i]到coefs[4*i+3]
+	std::vector<double> integralPrefix;//integralPrefix[k]为xi[0]到xi[k]的积分
 
 	/* 初始化插值参数
 	* xi代表所有节点的x坐标，必须依次递增，不得递减或相等
@@ -25,17 +72,168 @@ public:
 	* mr为右侧的二阶导数
 	* oSize是初始节点的个数，此处至少为3个
 	*/
-	void initVector(vector<float> &xi, vector<float> &yi, float ml, float mr, int oSize);
+	void initVector(std::vector<float> &xi, std::vector<float> &yi, float ml, float mr, int oSize);
+
+	/* 设置边界条件，需在calcCoefs之前调用
+	* type为SplineBoundary中的一种
+	* left、right在SPLINE_NATURAL时为两端的二阶导数，在SPLINE_CLAMPED时为两端的一阶导数，SPLINE_PERIODIC时忽略
+	*/
+	void setBoundary(int type, float left = 0, float right = 0);
+
+	/* 设置插值方法，需在calcCoefs之前调用
+	* type为SplineMethod中的一种，SPLINE_PCHIP和SPLINE_AKIMA只使用相邻节点计算斜率，边界条件不起作用
+	*/
+	void setMethod(int type);
+
+	/* 只修改一个节点的y坐标并更新系数
+	* SPLINE_PCHIP和SPLINE_AKIMA只重新计算该节点附近的几个区间，SPLINE_CUBIC需要重新求解
+	* k为节点的序号，y为新的y坐标
+	*/
+	void updateKnot(int k, float y);
+
+	/* 节点的x坐标不变、只有y坐标变化时重新计算系数，复用已分解的三对角矩阵
+	* yi代表所有节点新的y坐标，个数与原来相同
+	* 个数不足，或SPLINE_PERIODIC时首尾的y不相同，返回false且不修改原来的样条
+	*/
+	bool refitY(std::vector<float> &yi);
 
 	/* 计算各种矩阵系数 */
 	void calcCoefs();
 
-	/* 计算某点在三次样条曲线上的坐标
+	/* 计算某点在三次样条曲线上的坐标，超出范围的点按构造时指定的方式处理
 	* x为该点的x坐标
 	*/
 	float evaluate(float x);
 
-	/* 计算2阶导数 */
-	void derivative2(vector<float> &dx, vector<float> &d1, vector<float> &d2);
+	/* 批量计算多个点在三次样条曲线上的坐标，相邻的点只需向后移动区间，不必每次从头查找
+	* x为各点的x坐标，必须依次递增
+	* y返回各点的y坐标，超出范围的点按构造时指定的方式处理
+	* 返回超出范围的点数
+	*/
+	int evaluate(const std::vector<float> &x, std::vector<float> &y);
+
+	/* 批量计算多个点的一阶或二阶导数，直接对区间多项式求导
+	* x为各点的x坐标，必须依次递增
+	* dy返回各点的导数，超出范围的点按最近区间的多项式外推
+	* order为导数的阶数，1或2
+	*/
+	void evaluateDerivative(const std::vector<float> &x, std::vector<float> &dy, int order);
+
+	/* 计算[a, b]上的定积分，a大于b时结果为负，超出范围的部分按最近区间的多项式外推 */
+	float integrate(float a, float b);
+
+	/* 批量计算多个区间的定积分，每个区间用二分查找定位，与节点数成对数关系
+	* a、b为各区间的起点和终点，个数相同
+	* s返回各区间的积分
+	*/
+	void integrate(const std::vector<float> &a, const std::vector<float> &b, std::vector<float> &s);
+
+	/* 由当前的节点和系数生成不可修改的样条，需在calcCoefs之后调用
+	* 之后再修改本对象或重新拟合都不影响已生成的样条
+	*/
+	std::shared_ptr<const FittedSpline> fit() const;
+
+	/* 计算2阶导数
+	* dx为各区间的长度，d1为各区间的斜率
+	* d2返回各节点的二阶导数，SPLINE_NATURAL时d2[0]和d2[N-1]为给定值
+	*/
+	void derivative2(std::vector<float> &dx, std::vector<float> &d1, std::vector<float> &d2);
+
+	/* 按当前的节点和边界类型分解三对角矩阵，之后可用solveDerivative2求解 */
+	void factorKnots();
+
+	/* 节点的x坐标不变时，只求给定y坐标对应的各节点二阶导数，不修改本样条的系数
+	* 需先调用factorKnots或calcCoefs，之后可在多个线程中同时调用
+	* y为所有节点的y坐标，d2返回各节点的二阶导数，work为调用者提供的临时内存
+	*/
+	void solveDerivative2(const std::vector<float> &y, std::vector<float> &d2, std::vector<float> &work) const;
+
+private:
+	/* 超出范围的处理方式及对应的计算函数，不输出任何信息，可在多个线程中同时调用 */
+	int outOfRange;
+	SplinePointKernel pointKernel;
+	SplineBatchKernel batchKernel;
+
+	/* 当前节点和系数的只读视图 */
+	SplineView getView() const;
+
+	/* 三对角矩阵的LU分解，只与节点的x坐标和边界类型有关 */
+	bool isFactored;
+	std::vector<float> lower, pivot, upper;//下对角线消元系数、主元、上对角线
+	std::vector<float> knotDx;//分解时各区间的长度
+	std::vector<float> cyclicZ;//周期边界时Sherman–Morrison修正向量
+	float cyclicCorner, cyclicGamma, cyclicFactor;
+
+	/* 按当前的节点和边界类型分解三对角矩阵 */
+	void factorize(std::vector<float> &dx);
+
+	/* 用分解好的三对角矩阵求解，v为右端项，结果写回v */
+	void solveFactored(float *v) const;
+
+	/* 由各区间的斜率d1构造右端项v并求解，结果写入d2 */
+	void solveMoments(const float *d1, float *v, std::vector<float> &d2) const;
+
+	/* 局部方法（PCHIP、Akima）各节点的一阶导数 */
+	std::vector<float> slopes;
+
+	/* 局部方法中第i个节点的一阶导数，只用到相邻节点 */
+	float localSlope(int i) const;
+
+	/* 由两端节点的一阶导数计算第i个区间的Hermite多项式系数 */
+	void setHermiteCoefs(int i);
+
+	/* 从第from个区间开始重新计算积分的前缀和 */
+	void calcIntegralPrefix(int from);
+};
+
+/* 拟合完成后不可修改的样条：节点和系数连续存储，构造后所有成员都不再变化，
+* 可由多个线程通过shared_ptr共享并同时计算，不需要加锁，也不必每个线程复制一份
+*/
+class FittedSpline
+{
+public:
+	/* 复制节点、系数和积分前缀和，outOfRange为SplineOutOfRange中的一种 */
+	FittedSpline(const std::vector<float> &xi, const std::vector<float> &yi, const std::vector<float> &coefs,
+		const std::vector<double> &integralPrefix, int size, int outOfRange);
+
+	/* 节点个数 */
+	int getSize() const;
+
+	/* 与CubicInterpolation中的同名函数相同 */
+	float evaluate(float x) const;
+	int evaluate(const std::vector<float> &x, std::vector<float> &y) const;
+	void evaluateDerivative(const std::vector<float> &x, std::vector<float> &dy, int order) const;
+	float integrate(float a, float b) const;
+	void integrate(const std::vector<float> &a, const std::vector<float> &b, std::vector<float> &s) const;
+
+private:
+	const std::vector<float> xi, yi, coefs;
+	const std::vector<double> integralPrefix;
+	SplineView view;
+	SplinePointKernel pointKernel;
+	SplineBatchKernel batchKernel;
+
+	//视图指向自身的数据，不能复制
+	FittedSpline(const FittedSpline &) = delete;
+	FittedSpline &operator=(const FittedSpline &) = delete;
+};
+
+/* 可原子替换的共享样条：计算线程用load取得当前样条，重新拟合后用publish整体替换，
+* 正在使用旧样条的线程不受影响，旧样条在最后一个使用者释放后析构
+*/
+class SharedSpline
+{
+public:
+	SharedSpline();
+	explicit SharedSpline(std::shared_ptr<const FittedSpline> spline);
+
+	/* 取得当前的样条，可在多个线程中同时调用 */
+	std::shared_ptr<const FittedSpline> load() const;
+
+	/* 替换为新的样条，可与load同时调用 */
+	void publish(std::shared_ptr<const FittedSpline> spline);
+
+private:
+	std::shared_ptr<const FittedSpline> current;
 };
 
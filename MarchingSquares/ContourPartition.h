@@ -0,0 +1,662 @@
+﻿#pragma once
+#include <vector>
+#include <list>
+#include <map>
+#include <cstdio>
+#include <cstring>
+#include "IsolineTools.h"
+#include "TaskScheduler.h"
+#include "MarchingSquares.h"
+
+using namespace std;
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: 多进程（以后可以是多节点）分区生成等值线
+ *	整个网格按行划分为若干分区，相邻分区共用一行格点；每个工作进程只读取自己分区的格点，
+ *	用任务并行版本生成等值线，不跨越接缝的等值线直接作为结果，端点落在接缝行水平边上的片段
+ *	只保存整个网格中的边编号和点，写入紧凑的二进制数据（文件或共享内存）；
+ *	协调进程按接缝上的边编号连接各分区的片段，再与各分区的内部等值线合并。
+ *	接缝上的交点由两个分区用相同的格点值和整个网格的坐标插值，连接时只保留一个
+/************************************************************************/
+namespace marchingsquares
+{
+
+const unsigned int PARTITION_MAGIC = 0x5450534D;//序列化数据的标识"MSPT"
+const int PARTITION_VERSION = 1;//序列化格式的版本
+
+/**  接缝片段端点的类型 **/
+enum FragmentEnd
+{
+	FRAGMENT_END_OPEN = 0,//止于网格边界
+	FRAGMENT_END_MISSING = 1,//止于缺测区域
+	FRAGMENT_END_SEAM = 2//落在接缝上，需要与相邻分区的片段连接
+};
+
+/**  接缝片段：至少一个端点落在接缝上的等值线 **/
+struct SeamFragment
+{
+	int level;//等值编号（PartitionResult::isovalues中的下标）
+	unsigned long long headId;//首个交点所在边在整个网格中的编号（不含等值编号）
+	unsigned long long tailId;//最后一个交点所在边在整个网格中的编号
+	char headEnd;//首端点的类型（FragmentEnd）
+	char tailEnd;//尾端点的类型
+	isotools::Isoline line;//片段的点
+};
+
+/**  一个分区的结果，由工作进程生成、序列化后交给协调进程 **/
+struct PartitionResult
+{
+	int rowBegin;//分区第一行格点在整个网格中的行号
+	int rowEnd;//分区最后一行格点的行号（与下一个分区共用）
+	int cols;//每行格点数
+	vector<float> isovalues;//实际使用的等值，与interiorLines一一对应
+	vector< vector<isotools::Isoline>> interiorLines;//不跨越接缝的等值线，startPoint/endPoint为整个网格中的下标
+	vector<SeamFragment> fragments;//接缝片段
+
+	PartitionResult() : rowBegin(0), rowEnd(0), cols(0) {}
+};
+
+/************************************************************************/
+/* Funciton: getPartitionStart
+ * Description: 把整个网格按行均分为若干分区，第p个分区包含第partStart[p]行到第partStart[p + 1]行格点（首尾两行都包含），
+ *	相邻分区共用一行；每个分区至少TASK_BAND_MIN_ROWS行cell
+ * Input:
+	rows: 整个网格的行数
+	partNum: 期望的分区数量
+	partStart: 返回每个分区的起始行，最后一个元素为最后一行的行号
+ * Output: 实际的分区数量
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int getPartitionStart(int rows, int partNum, vector<int> &partStart)
+{
+	if (rows < 2)
+	{
+		partStart.assign(1, 0);
+		return 0;
+	}
+	return getBandStart(rows - 1, partNum, partStart);
+}
+
+/************************************************************************/
+/* Funciton: contourPartition 【在工作进程中调用】
+ * Description: 生成一个分区的等值线，并分为内部等值线与接缝片段
+ *	maxGridValue/minGridValue应当使用整个网格的范围，保证各分区去掉的等值相同；
+ *	options中的掩码、块索引和格点坐标都应当只对应本分区，未给出格点坐标时按整个网格的行号计算y坐标，
+ *	与整个网格一次生成的坐标逐位相同
+ * Input:
+	context: 上下文，可以在多个分区、多次调用之间复用
+	data: 本分区的格点数据（vector< vector<float> >或GridView），第0行是整个网格的第rowBegin行
+	rowBegin: 本分区第一行在整个网格中的行号
+	rows: 整个网格的行数
+	isovalues: 等值线值数组
+	startLongitude: 整个网格的起始经度（起始x坐标）
+	longitudeGridSpace: 经度间隔（x坐标间隔）
+	startLatitude: 整个网格的起始纬度（起始y坐标）
+	latitudeGridSpace: 纬度间隔（y坐标间隔）
+	maxGridValue: 整个网格中的最大值
+	minGridValue: 整个网格中的最小值
+	result: 返回本分区的结果
+	scheduler: 任务调度器，为NULL时使用默认的work-stealing线程池
+	options: 缺测值、格点坐标等可选设置，为NULL时不判断缺测并使用规则网格
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<class Grid>
+static void contourPartition(ContourContext &context, const Grid &data, int rowBegin, int rows, const vector<float> &isovalues,
+	float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace, float maxGridValue, float minGridValue,
+	PartitionResult &result, TaskScheduler *scheduler = NULL, const ContourOptions *options = NULL)
+{
+	int bandRows = getGridRows(data);
+	int cols = bandRows > 0 ? getGridCols(data) : 0;
+	result.rowBegin = rowBegin;
+	result.rowEnd = rowBegin + bandRows - 1;
+	result.cols = cols;
+	result.isovalues.assign(isovalues.begin(), isovalues.end());
+	result.interiorLines.clear();
+	result.fragments.clear();
+
+	//没有缺测设置时关闭NaN判断，与options为NULL时的结果相同
+	ContourOptions bandOptions;
+	if (options != NULL)
+	{
+		bandOptions = *options;
+	}
+	else
+	{
+		bandOptions.checkNaN = false;
+	}
+	GridCoordinates coordinates;
+	vector<float> yValues;
+	if (bandOptions.coordinates == NULL || (bandOptions.coordinates->yValues == NULL && bandOptions.coordinates->nodeY == NULL))
+	{
+		if (bandOptions.coordinates != NULL)
+		{
+			coordinates = *bandOptions.coordinates;
+		}
+		yValues.resize(bandRows);
+		for (int i = 0; i < bandRows; ++i)
+		{
+			yValues[i] = (i + rowBegin) * latitudeGridSpace + startLatitude;
+		}
+		coordinates.yValues = &yValues;
+		bandOptions.coordinates = &coordinates;
+	}
+	vector< vector<isotools::Isoline>> &pathLinesV = doMarchingSquaresAccelerateTask(context, data, result.isovalues,
+		startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace, maxGridValue, minGridValue, scheduler, &bandOptions);
+
+	//端点在首行（不是整个网格的首行）或末行（不是整个网格的末行）的水平边上即为接缝端点
+	bool hasTopSeam = rowBegin > 0;
+	bool hasBottomSeam = result.rowEnd < rows - 1;
+	unsigned long long mask = (1ULL << EDGE_ID_LEVEL_SHIFT) - 1;
+	unsigned long long idOffset = (unsigned long long)rowBegin * cols * 2;
+	auto getEndType = [&](unsigned long long id) -> FragmentEnd
+	{
+		unsigned long long edge = id & mask;
+		int i = (int)(edge / 2 / cols);
+		if (edge % 2 == 1 && ((i == 0 && hasTopSeam) || (i == bandRows - 1 && hasBottomSeam)))
+		{
+			return FRAGMENT_END_SEAM;
+		}
+		if (options != NULL && isMaskBorderPoint(getEdgeIdMiddlePoint(edge, cols), data, &bandOptions))
+		{
+			return FRAGMENT_END_MISSING;
+		}
+		return FRAGMENT_END_OPEN;
+	};
+	int levelsNum = result.isovalues.size();
+	result.interiorLines.resize(levelsNum);
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		EdgeIdLines &lines = context.levelLines[m];
+		int linesNum = lines.size();
+		for (int k = 0; k < linesNum; ++k)
+		{
+			isotools::Isoline &line = pathLinesV[m][k];
+			unsigned long long headId = lines.ids[lines.start[k]];
+			unsigned long long tailId = lines.ids[lines.start[k + 1] - 1];
+			FragmentEnd headEnd = lines.isCircle[k] ? FRAGMENT_END_OPEN : getEndType(headId);
+			FragmentEnd tailEnd = lines.isCircle[k] ? FRAGMENT_END_OPEN : getEndType(tailId);
+			if (headEnd != FRAGMENT_END_SEAM && tailEnd != FRAGMENT_END_SEAM)
+			{
+				result.interiorLines[m].push_back(isotools::Isoline());
+				isotools::Isoline &interior = result.interiorLines[m].back();
+				swap(interior, line);
+				interior.startPoint.x += rowBegin;
+				interior.endPoint.x += rowBegin;
+				continue;
+			}
+			result.fragments.push_back(SeamFragment());
+			SeamFragment &fragment = result.fragments.back();
+			fragment.level = m;
+			fragment.headId = (headId & mask) + idOffset;
+			fragment.tailId = (tailId & mask) + idOffset;
+			fragment.headEnd = (char)headEnd;
+			fragment.tailEnd = (char)tailEnd;
+			swap(fragment.line, line);
+		}
+	}
+}
+
+template<class T>
+static void appendPartitionValue(vector<char> &buffer, const T &value)
+{
+	const char *bytes = (const char *)&value;
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+static void appendPartitionPoints(vector<char> &buffer, const list<isotools::Point2D> &points)
+{
+	appendPartitionValue(buffer, (int)points.size());
+	list<isotools::Point2D>::const_iterator it = points.begin();
+	list<isotools::Point2D>::const_iterator it_end = points.end();
+	for (; it != it_end; ++it)
+	{
+		appendPartitionValue(buffer, it->x);
+		appendPartitionValue(buffer, it->y);
+	}
+}
+
+/**  按顺序读取序列化数据，越界时置失败标志，之后读到的都是0 **/
+struct PartitionReader
+{
+	const char *bytes;
+	size_t size;
+	size_t pos;
+	bool failed;
+
+	PartitionReader(const char *bytes, size_t size) : bytes(bytes), size(size), pos(0), failed(false) {}
+
+	template<class T>
+	T read()
+	{
+		T value;
+		if (failed || size - pos < sizeof(T))
+		{
+			failed = true;
+			memset(&value, 0, sizeof(T));
+			return value;
+		}
+		memcpy(&value, bytes + pos, sizeof(T));
+		pos += sizeof(T);
+		return value;
+	}
+
+	/* 读到的数量是否可信：剩余数据至少能放下count个最短的记录，避免按损坏的数量分配内存 */
+	bool isCountValid(int count, size_t recordSize) const
+	{
+		return !failed && count >= 0 && (size_t)count <= (size - pos) / recordSize;
+	}
+
+	/* 读取点数和点，长度、叉积和外包矩形按点重新计算 */
+	void readPoints(isotools::Isoline &line)
+	{
+		int pointsNum = read<int>();
+		if (!isCountValid(pointsNum, sizeof(float) * 2))
+		{
+			failed = true;
+			return;
+		}
+		line.points.clear();
+		isotools::resetIsolineMetrics(line);
+		for (int k = 0; k < pointsNum; ++k)
+		{
+			isotools::Point2D point;
+			point.x = read<float>();
+			point.y = read<float>();
+			isotools::pushBackPoint(line, point);
+		}
+	}
+};
+
+/************************************************************************/
+/* Funciton: writePartition
+ * Description: 把分区结果序列化为紧凑的二进制数据（本机字节序），可以写入文件、共享内存或通过网络发送；
+ *	点只保存坐标，长度、叉积和外包矩形在读取时重新计算
+ * Input:
+	result: 分区结果
+	buffer: 返回序列化后的数据
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void writePartition(const PartitionResult &result, vector<char> &buffer)
+{
+	buffer.clear();
+	appendPartitionValue(buffer, PARTITION_MAGIC);
+	appendPartitionValue(buffer, PARTITION_VERSION);
+	appendPartitionValue(buffer, result.rowBegin);
+	appendPartitionValue(buffer, result.rowEnd);
+	appendPartitionValue(buffer, result.cols);
+	int levelsNum = result.isovalues.size();
+	appendPartitionValue(buffer, levelsNum);
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		appendPartitionValue(buffer, result.isovalues[m]);
+	}
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		int linesNum = m < (int)result.interiorLines.size() ? result.interiorLines[m].size() : 0;
+		appendPartitionValue(buffer, linesNum);
+		for (int k = 0; k < linesNum; ++k)
+		{
+			const isotools::Isoline &line = result.interiorLines[m][k];
+			appendPartitionValue(buffer, (char)((line.isCircle ? 1 : 0) | (line.isBorder ? 2 : 0)));
+			appendPartitionValue(buffer, line.startPoint.x);
+			appendPartitionValue(buffer, line.startPoint.y);
+			appendPartitionValue(buffer, line.endPoint.x);
+			appendPartitionValue(buffer, line.endPoint.y);
+			appendPartitionPoints(buffer, line.points);
+		}
+	}
+	int fragmentsNum = result.fragments.size();
+	appendPartitionValue(buffer, fragmentsNum);
+	for (int f = 0; f < fragmentsNum; ++f)
+	{
+		const SeamFragment &fragment = result.fragments[f];
+		appendPartitionValue(buffer, fragment.level);
+		appendPartitionValue(buffer, fragment.headId);
+		appendPartitionValue(buffer, fragment.tailId);
+		appendPartitionValue(buffer, fragment.headEnd);
+		appendPartitionValue(buffer, fragment.tailEnd);
+		appendPartitionPoints(buffer, fragment.line.points);
+	}
+}
+
+/************************************************************************/
+/* Funciton: readPartition
+ * Description: 从writePartition生成的二进制数据恢复分区结果
+ * Input:
+	bytes: 序列化数据
+	size: 数据长度（字节）
+	result: 返回分区结果
+ * Output: 成功返回true，标识、版本不符、数据不完整或数量超出剩余数据时返回false
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static bool readPartition(const char *bytes, size_t size, PartitionResult &result)
+{
+	PartitionReader reader(bytes, size);
+	if (reader.read<unsigned int>() != PARTITION_MAGIC || reader.read<int>() != PARTITION_VERSION)
+	{
+		return false;
+	}
+	result.rowBegin = reader.read<int>();
+	result.rowEnd = reader.read<int>();
+	result.cols = reader.read<int>();
+	//最短的等值线记录：标志、首尾端点和点数；最短的片段记录：等值编号、首尾边编号、首尾类型和点数
+	const size_t lineRecordSize = sizeof(char) + sizeof(float) * 4 + sizeof(int);
+	const size_t fragmentRecordSize = sizeof(int) + sizeof(unsigned long long) * 2 + sizeof(char) * 2 + sizeof(int);
+	int levelsNum = reader.read<int>();
+	if (!reader.isCountValid(levelsNum, sizeof(float)))
+	{
+		return false;
+	}
+	result.isovalues.resize(levelsNum);
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		result.isovalues[m] = reader.read<float>();
+	}
+	result.interiorLines.assign(levelsNum, vector<isotools::Isoline>());
+	for (int m = 0; m < levelsNum && !reader.failed; ++m)
+	{
+		int linesNum = reader.read<int>();
+		if (!reader.isCountValid(linesNum, lineRecordSize))
+		{
+			return false;
+		}
+		result.interiorLines[m].resize(linesNum);
+		for (int k = 0; k < linesNum && !reader.failed; ++k)
+		{
+			isotools::Isoline &line = result.interiorLines[m][k];
+			char flags = reader.read<char>();
+			line.isovalue = result.isovalues[m];
+			line.isCircle = (flags & 1) != 0;
+			line.isBorder = (flags & 2) != 0;
+			line.startPoint.x = reader.read<float>();
+			line.startPoint.y = reader.read<float>();
+			line.endPoint.x = reader.read<float>();
+			line.endPoint.y = reader.read<float>();
+			reader.readPoints(line);
+		}
+	}
+	int fragmentsNum = reader.read<int>();
+	if (!reader.isCountValid(fragmentsNum, fragmentRecordSize))
+	{
+		return false;
+	}
+	result.fragments.resize(fragmentsNum);
+	for (int f = 0; f < fragmentsNum && !reader.failed; ++f)
+	{
+		SeamFragment &fragment = result.fragments[f];
+		fragment.level = reader.read<int>();
+		fragment.headId = reader.read<unsigned long long>();
+		fragment.tailId = reader.read<unsigned long long>();
+		fragment.headEnd = reader.read<char>();
+		fragment.tailEnd = reader.read<char>();
+		if (fragment.level < 0 || fragment.level >= levelsNum)
+		{
+			return false;
+		}
+		fragment.line.isovalue = result.isovalues[fragment.level];
+		fragment.line.isCircle = false;
+		fragment.line.isBorder = false;
+		reader.readPoints(fragment.line);
+	}
+	return !reader.failed;
+}
+
+/************************************************************************/
+/* Funciton: writePartitionFile
+ * Description: 把分区结果写入文件（接缝文件），供协调进程读取
+ * Input:
+	path: 文件路径
+	result: 分区结果
+ * Output: 成功返回true
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static bool writePartitionFile(const char *path, const PartitionResult &result)
+{
+	vector<char> buffer;
+	writePartition(result, buffer);
+	FILE *file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		return false;
+	}
+	bool isWritten = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+	return fclose(file) == 0 && isWritten;
+}
+
+/************************************************************************/
+/* Funciton: readPartitionFile
+ * Description: 读取writePartitionFile写入的接缝文件
+ * Input:
+	path: 文件路径
+	result: 返回分区结果
+ * Output: 成功返回true
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static bool readPartitionFile(const char *path, PartitionResult &result)
+{
+	FILE *file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+	vector<char> buffer;
+	char block[65536];
+	size_t readNum;
+	while ((readNum = fread(block, 1, sizeof(block), file)) > 0)
+	{
+		buffer.insert(buffer.end(), block, block + readNum);
+	}
+	fclose(file);
+	return readPartition(buffer.data(), buffer.size(), result);
+}
+
+/************************************************************************/
+/* Funciton: linkSeamFragments
+ * Description: 按接缝上的边编号连接同一等值的片段（与linkEdgeIdPieces相同的方式），
+ *	共用的交点只保留一个；连接后仍落在接缝上的端点只能是相邻分区的cell缺测，标记为边界线
+ * Input:
+	fragments: 同一等值的所有片段，连接后点被移走
+	cols: 每行格点数
+	lines: 连接好的等值线追加到这里
+	linkTable: 连接用的哈希表，由调用者提供以便复用内存
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void linkSeamFragments(vector<SeamFragment *> &fragments, int cols, vector<isotools::Isoline> &lines, EdgeLinkTable &linkTable)
+{
+	int fragmentsNum = fragments.size();
+	if (fragmentsNum == 0)
+	{
+		return;
+	}
+	linkTable.reset(fragmentsNum);
+	for (int p = 0; p < fragmentsNum; ++p)
+	{
+		linkTable.add(fragments[p]->headId, p);
+		linkTable.add(fragments[p]->tailId, p);
+	}
+
+	vector<char> &used = linkTable.used;
+	for (int p = 0; p < fragmentsNum; ++p)
+	{
+		if (used[p])
+		{
+			continue;
+		}
+		//向前找到链的起点，回到自身说明构成环
+		int head = p;
+		bool headForward = true;
+		bool isCircle = false;
+		while (true)
+		{
+			unsigned long long id = headForward ? fragments[head]->headId : fragments[head]->tailId;
+			int prev = linkTable.getOther(id, head);
+			if (prev < 0)
+			{
+				break;
+			}
+			if (prev == p)
+			{
+				isCircle = true;
+				head = p;
+				headForward = true;
+				break;
+			}
+			headForward = fragments[prev]->tailId == id;
+			head = prev;
+		}
+
+		//从起点依次连接，后一个片段的首点与前一个片段的尾点是同一个交点
+		lines.push_back(isotools::Isoline());
+		isotools::Isoline &line = lines.back();
+		line.isovalue = fragments[head]->line.isovalue;
+		line.isCircle = isCircle;
+		unsigned long long headId = headForward ? fragments[head]->headId : fragments[head]->tailId;
+		char headEnd = headForward ? fragments[head]->headEnd : fragments[head]->tailEnd;
+		unsigned long long tailId = headId;
+		char tailEnd = headEnd;
+		int current = head;
+		bool currentForward = headForward;
+		while (true)
+		{
+			used[current] = 1;
+			SeamFragment &fragment = *fragments[current];
+			list<isotools::Point2D> &points = fragment.line.points;
+			if (!currentForward)
+			{
+				points.reverse();
+			}
+			if (!line.points.empty() && !points.empty())
+			{
+				points.pop_front();
+			}
+			line.points.splice(line.points.end(), points);
+			tailId = currentForward ? fragment.tailId : fragment.headId;
+			tailEnd = currentForward ? fragment.tailEnd : fragment.headEnd;
+			int next = linkTable.getOther(tailId, current);
+			if (next < 0 || used[next])
+			{
+				break;
+			}
+			currentForward = fragments[next]->headId == tailId;
+			current = next;
+		}
+		if (isCircle && line.points.size() > 1)
+		{
+			line.points.pop_back();
+		}
+		isotools::calcIsolineMetrics(line);
+		line.startPoint = getEdgeIdMiddlePoint(headId, cols);
+		line.endPoint = isCircle ? line.startPoint : getEdgeIdMiddlePoint(tailId, cols);
+		line.isBorder = !isCircle && (headEnd != FRAGMENT_END_OPEN || tailEnd != FRAGMENT_END_OPEN);
+	}
+}
+
+/************************************************************************/
+/* Funciton: mergePartitions 【在协调进程中调用】
+ * Description: 合并各分区的结果：各等值的片段按接缝上的边编号连接（每个等值一个任务），
+ *	再把各分区的内部等值线依次接在后面；等值按数值对应，各分区实际使用的等值可以不同
+ * Input:
+	parts: 各分区的结果，按行的顺序排列，合并后其中的等值线被移走
+	isovalues: 返回合并后的等值，与pathLinesV一一对应
+	pathLinesV: 返回整个网格的所有等值线
+	scheduler: 任务调度器，为NULL时使用默认的work-stealing线程池
+ * Output: 成功返回true；各分区每行格点数不同（边编号无法对应）时返回false，结果为空
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static bool mergePartitions(vector<PartitionResult> &parts, vector<float> &isovalues, vector< vector<isotools::Isoline>> &pathLinesV,
+	TaskScheduler *scheduler = NULL)
+{
+	isovalues.clear();
+	pathLinesV.clear();
+	int partsNum = parts.size();
+	if (partsNum == 0)
+	{
+		return true;
+	}
+	int cols = parts[0].cols;
+	for (int p = 1; p < partsNum; ++p)
+	{
+		if (parts[p].cols != cols)
+		{
+			return false;
+		}
+	}
+
+	//各分区的等值编号 -> 合并后的等值编号
+	map<float, int> levelOf;
+	vector< vector<int> > partLevel(partsNum);
+	for (int p = 0; p < partsNum; ++p)
+	{
+		int levelsNum = parts[p].isovalues.size();
+		partLevel[p].resize(levelsNum);
+		for (int m = 0; m < levelsNum; ++m)
+		{
+			map<float, int>::iterator it = levelOf.find(parts[p].isovalues[m]);
+			if (it == levelOf.end())
+			{
+				it = levelOf.insert(make_pair(parts[p].isovalues[m], (int)isovalues.size())).first;
+				isovalues.push_back(parts[p].isovalues[m]);
+			}
+			partLevel[p][m] = it->second;
+		}
+	}
+	int levelsNum = isovalues.size();
+	pathLinesV.resize(levelsNum);
+	vector< vector<SeamFragment *> > levelFragments(levelsNum);
+	for (int p = 0; p < partsNum; ++p)
+	{
+		int fragmentsNum = parts[p].fragments.size();
+		for (int f = 0; f < fragmentsNum; ++f)
+		{
+			levelFragments[partLevel[p][parts[p].fragments[f].level]].push_back(&parts[p].fragments[f]);
+		}
+	}
+
+	vector< function<void()> > tasks;
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		tasks.push_back([&, m]()
+		{
+			EdgeLinkTable linkTable;
+			linkSeamFragments(levelFragments[m], cols, pathLinesV[m], linkTable);
+			for (int p = 0; p < partsNum; ++p)
+			{
+				int partLevelsNum = partLevel[p].size();
+				for (int n = 0; n < partLevelsNum; ++n)
+				{
+					if (partLevel[p][n] != m || n >= (int)parts[p].interiorLines.size())
+					{
+						continue;
+					}
+					vector<isotools::Isoline> &interiorLines = parts[p].interiorLines[n];
+					int linesNum = interiorLines.size();
+					for (int k = 0; k < linesNum; ++k)
+					{
+						pathLinesV[m].push_back(isotools::Isoline());
+						swap(pathLinesV[m].back(), interiorLines[k]);
+					}
+				}
+			}
+		});
+	}
+	if (scheduler == NULL)
+	{
+		scheduler = getDefaultScheduler();
+	}
+	scheduler->runTasks(tasks);
+	return true;
+}
+
+}
@@ -0,0 +1,235 @@
+﻿#pragma once
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include "IsolineTools.h"
+#include "MarchingSquares.h"
+
+using namespace std;
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: 多帧（时间序列）等值线的流水线驱动
+ *	读取线程加载第t+1帧、计算线程生成第t帧、写出线程输出第t-1帧，三个阶段同时进行；
+ *	帧缓冲区的数量固定，各帧轮流使用，计算阶段的临时内存由ContourWorkspace在各帧之间复用，
+ *	每帧的耗时趋近于最慢的一个阶段，而不是各阶段之和
+/************************************************************************/
+namespace marchingsquares
+{
+
+/**  流水线中的一帧：格点数据、等值和结果的内存在各帧之间重复使用 **/
+struct ContourFrame
+{
+	int index;//帧序号
+	vector<vector<float> > data;//格点数据
+	float maxGridValue;//格点中的最大值
+	float minGridValue;//格点中的最小值
+	vector<float> isovalues;//本帧实际使用的等值（超出数据范围的等值已去掉），与pathLinesV一一对应
+	vector< vector<isotools::Isoline>> pathLinesV;//本帧的等值线
+
+	ContourFrame() : index(-1), maxGridValue(0), minGridValue(0) {}
+};
+
+/**  流水线各阶段的累计耗时 **/
+struct PipelineStats
+{
+	double loadTime;//读取阶段耗时，毫秒
+	double contourTime;//计算阶段耗时，毫秒
+	double writeTime;//写出阶段耗时，毫秒
+	double totalTime;//总耗时，毫秒
+	int frameNum;//处理的帧数
+
+	PipelineStats() : loadTime(0), contourTime(0), writeTime(0), totalTime(0), frameNum(0) {}
+};
+
+/**  在流水线的两个阶段之间传递帧，NULL表示上游已经结束 **/
+class FrameQueue
+{
+public:
+	void push(ContourFrame *frame)
+	{
+		{
+			lock_guard<mutex> guard(lock);
+			frames.push_back(frame);
+		}
+		cond.notify_one();
+	}
+
+	ContourFrame *pop()
+	{
+		unique_lock<mutex> guard(lock);
+		cond.wait(guard, [&]() { return !frames.empty(); });
+		ContourFrame *frame = frames.front();
+		frames.pop_front();
+		return frame;
+	}
+
+private:
+	mutex lock;
+	condition_variable cond;
+	deque<ContourFrame *> frames;
+};
+
+/************************************************************************/
+/* Funciton: doMarchingSquaresFrames
+ * Description: 按流水线方式生成多帧格点数据的等值线，每帧使用doMarchingSquaresAccelerateOMP计算
+ * Input:
+	frameNum: 最多处理的帧数
+	loader: 读取第frame帧的格点数据及其最大、最小值，在读取线程中调用；返回false表示没有更多的帧
+	writer: 输出一帧的结果，在写出线程中按帧序号依次调用；返回后该帧的内存会被下一帧重复使用
+	isovalues: 等值线值数组，每帧使用同一组等值
+	startLongitude: 起始经度（起始x坐标）
+	longitudeGridSpace: 经度间隔（x坐标间隔）
+	startLatitude: 起始纬度（起始y坐标）
+	latitudeGridSpace: 纬度间隔（y坐标间隔）
+	options: 缺测值、格点坐标等可选设置，为NULL时不判断缺测并使用规则网格
+	slotNum: 帧缓冲区的数量，至少为3（读取、计算、写出各一个），更多时可以吸收各阶段耗时的波动
+	stats: 可选的各阶段耗时统计，为NULL时不统计
+ * Output: 处理的帧数；任一阶段抛出异常时，其余阶段停止处理新的帧，所有线程结束后重新抛出第一个异常
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int doMarchingSquaresFrames(int frameNum,
+	const function<bool(int frame, vector<vector<float> > &data, float &maxGridValue, float &minGridValue)> &loader,
+	const function<void(const ContourFrame &frame)> &writer,
+	const vector<float> &isovalues, float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace,
+	const ContourOptions *options = NULL, int slotNum = 3, PipelineStats *stats = NULL)
+{
+	double startTime = getTimeMs();
+	if (slotNum < 3)
+	{
+		slotNum = 3;
+	}
+	vector<ContourFrame> frames(slotNum);
+	FrameQueue freeQueue, loadedQueue, doneQueue;
+	for (int k = 0; k < slotNum; ++k)
+	{
+		freeQueue.push(&frames[k]);
+	}
+
+	//各阶段的异常在本阶段捕获并记录，出错后各阶段只把帧传回空闲队列、不再处理，保证每个队列都能收到结束标志
+	mutex errorLock;
+	exception_ptr error;
+	atomic<bool> isFailed(false);
+	auto setError = [&]()
+	{
+		lock_guard<mutex> guard(errorLock);
+		if (!error)
+		{
+			error = current_exception();
+		}
+		isFailed = true;
+	};
+
+	double loadTime = 0, contourTime = 0, writeTime = 0;
+	thread loadThread([&]()
+	{
+		try
+		{
+			for (int t = 0; t < frameNum && !isFailed; ++t)
+			{
+				ContourFrame *frame = freeQueue.pop();
+				if (isFailed)
+				{
+					break;
+				}
+				double time = getTimeMs();
+				frame->index = t;
+				bool isLoaded = loader(t, frame->data, frame->maxGridValue, frame->minGridValue);
+				loadTime += getTimeMs() - time;
+				if (!isLoaded)
+				{
+					break;
+				}
+				loadedQueue.push(frame);
+			}
+		}
+		catch (...)
+		{
+			setError();
+		}
+		loadedQueue.push(NULL);
+	});
+	thread writeThread([&]()
+	{
+		ContourFrame *frame;
+		while ((frame = doneQueue.pop()) != NULL)
+		{
+			if (!isFailed)
+			{
+				try
+				{
+					double time = getTimeMs();
+					writer(*frame);
+					writeTime += getTimeMs() - time;
+				}
+				catch (...)
+				{
+					setError();
+				}
+			}
+			freeQueue.push(frame);
+		}
+	});
+
+	//计算阶段在当前线程中进行，内部由OpenMP并行
+	ContourWorkspace workspace;
+	int processedNum = 0;
+	ContourFrame *frame;
+	while ((frame = loadedQueue.pop()) != NULL)
+	{
+		if (isFailed)
+		{
+			freeQueue.push(frame);
+			continue;
+		}
+		try
+		{
+			double time = getTimeMs();
+			frame->isovalues.assign(isovalues.begin(), isovalues.end());
+			if (!frame->data.empty() && !frame->data[0].empty())
+			{
+				doMarchingSquaresAccelerateOMP(frame->data, frame->isovalues, frame->pathLinesV, startLongitude, longitudeGridSpace,
+					startLatitude, latitudeGridSpace, frame->maxGridValue, frame->minGridValue, options, &workspace);
+			}
+			else
+			{
+				frame->isovalues.clear();
+				frame->pathLinesV.clear();
+			}
+			contourTime += getTimeMs() - time;
+		}
+		catch (...)
+		{
+			setError();
+			freeQueue.push(frame);
+			continue;
+		}
+		doneQueue.push(frame);
+		++processedNum;
+	}
+	doneQueue.push(NULL);
+	loadThread.join();
+	writeThread.join();
+	if (error)
+	{
+		rethrow_exception(error);
+	}
+
+	if (stats != NULL)
+	{
+		stats->loadTime = loadTime;
+		stats->contourTime = contourTime;
+		stats->writeTime = writeTime;
+		stats->totalTime = getTimeMs() - startTime;
+		stats->frameNum = processedNum;
+	}
+	return processedNum;
+}
+
+}
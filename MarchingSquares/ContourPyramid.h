@@ -0,0 +1,336 @@
+﻿#pragma once
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include "IsolineTools.h"
+#include "TaskScheduler.h"
+#include "MarchingSquares.h"
+
+using namespace std;
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: 多分辨率（LOD）等值线金字塔
+ *	第k层的格点(i,j)对应第k-1层的格点(2i,2j)，经纬度间隔加倍、起始经纬度不变，各层等值线可以直接叠加显示；
+ *	每层由上一层逐级降采样（总计算量约为原始网格的4/3），降采样与块取值范围索引按行并行，
+ *	各层依次使用同一个ContourContext生成等值线，临时内存与链表结点在层之间、多次调用之间复用
+/************************************************************************/
+namespace marchingsquares
+{
+
+/**  降采样方式 **/
+enum PyramidReduce
+{
+	PYRAMID_MEAN = 0,//3 × 3邻域按(1,2,1)权重平均，保持均值，适合温度、气压等平滑场
+	PYRAMID_EXTREMA = 1//3 × 3邻域中最大值（或最小值）偏离均值明显大于另一侧时取该极值，否则取均值，保留极值中心，适合降水、风速等
+};
+
+const float PYRAMID_EXTREMA_RATIO = 2.0f;//PYRAMID_EXTREMA方式下，一侧偏离均值超过另一侧的该倍数时取该侧的极值
+
+/**  金字塔的一层 **/
+struct PyramidLevel
+{
+	int level;//层号，0为原始网格
+	int step;//该层一个格点间隔对应的原始格点间隔数（2的level次方）
+	vector<vector<float> > data;//该层的格点数据，第0层直接使用原始数据，不复制
+	float maxGridValue;//格点中的最大值（不含缺测）
+	float minGridValue;//格点中的最小值
+	float startLongitude;//起始经度
+	float longitudeGridSpace;//经度间隔
+	float startLatitude;//起始纬度
+	float latitudeGridSpace;//纬度间隔
+	vector<float> xValues;//直线网格每列的坐标（原始网格给出时才有）
+	vector<float> yValues;//直线网格每行的坐标
+	vector< vector<float> > nodeX;//曲线网格每个格点的x坐标（原始网格给出时才有）
+	vector< vector<float> > nodeY;//曲线网格每个格点的y坐标
+	GridCoordinates coordinates;//指向上面的坐标数组
+	ContourOptions options;//该层使用的设置
+	BlockRangeIndex blockIndex;//该层的块取值范围索引，blockSize大于0时建立
+	ContourStats stats;//该层的各阶段统计
+	vector<float> isovalues;//该层实际使用的等值（超出数据范围的等值已去掉），与pathLinesV一一对应
+	vector< vector<isotools::Isoline>> pathLinesV;//该层的等值线
+	IsolineIndex index;//该层等值线的空间索引，context.buildIndex为true时建立
+
+	PyramidLevel() : level(0), step(1), maxGridValue(0), minGridValue(0),
+		startLongitude(0), longitudeGridSpace(0), startLatitude(0), latitudeGridSpace(0) {}
+};
+
+/**  等值线金字塔：各层的数据与结果，以及生成等值线的上下文，多次调用之间复用内存 **/
+struct ContourPyramid
+{
+	vector<PyramidLevel> levels;//各层，levels[0]为原始网格
+	int levelNum;//本次调用实际生成的层数
+	ContourContext context;//各层共用的上下文
+
+	ContourPyramid() : levelNum(0) {}
+};
+
+/************************************************************************/
+/* Funciton: reducePyramidLevel
+ * Description: 由上一层降采样得到下一层，按行并行；邻域内的缺测格点不参与计算，全部缺测时置为NaN
+ * Input:
+	source: 上一层的格点数据
+	sourceOptions: 上一层的缺测值设置，为NULL时不判断缺测
+	reduceMode: 降采样方式（PyramidReduce）
+	target: 返回的下一层格点数据
+	scheduler: 任务调度器
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void reducePyramidLevel(vector<vector<float> > &source, const ContourOptions *sourceOptions, int reduceMode,
+	vector<vector<float> > &target, TaskScheduler *scheduler)
+{
+	int sourceRows = source.size(), sourceCols = source[0].size();
+	int rows = (sourceRows - 1) / 2 + 1, cols = (sourceCols - 1) / 2 + 1;
+	target.resize(rows);
+	parallelFor(scheduler, 0, rows, 1 + rows / (scheduler->getThreadNum() * 4), [&](int rowBegin, int rowEnd)
+	{
+		static const float weights[3] = { 1, 2, 1 };
+		for (int i = rowBegin; i < rowEnd; ++i)
+		{
+			target[i].resize(cols);
+			for (int j = 0; j < cols; ++j)
+			{
+				float sum = 0, weightSum = 0;
+				float minValue = FLT_MAX, maxValue = -FLT_MAX;
+				for (int di = -1; di <= 1; ++di)
+				{
+					int si = 2 * i + di;
+					if (si < 0 || si >= sourceRows)
+						continue;
+					for (int dj = -1; dj <= 1; ++dj)
+					{
+						int sj = 2 * j + dj;
+						if (sj < 0 || sj >= sourceCols)
+							continue;
+						float value = source[si][sj];
+						if (isMissingValue(sourceOptions, value, (long long)si * sourceCols + sj))
+							continue;
+						float weight = weights[di + 1] * weights[dj + 1];
+						sum += weight * value;
+						weightSum += weight;
+						minValue = value < minValue ? value : minValue;
+						maxValue = value > maxValue ? value : maxValue;
+					}
+				}
+				if (weightSum == 0)
+				{
+					target[i][j] = NAN;
+					continue;
+				}
+				float mean = sum / weightSum;
+				//平滑的坡面上两侧偏离相近，取均值，避免在最大值和最小值之间来回跳动
+				if (reduceMode == PYRAMID_EXTREMA && maxValue - mean > PYRAMID_EXTREMA_RATIO * (mean - minValue))
+				{
+					target[i][j] = maxValue;
+				}
+				else if (reduceMode == PYRAMID_EXTREMA && mean - minValue > PYRAMID_EXTREMA_RATIO * (maxValue - mean))
+				{
+					target[i][j] = minValue;
+				}
+				else
+				{
+					target[i][j] = mean;
+				}
+			}
+		}
+	});
+}
+
+/************************************************************************/
+/* Funciton: reducePyramidCoordinates
+ * Description: 按隔行隔列抽取下一层的格点坐标
+ * Input:
+	source: 上一层
+	target: 下一层，data已经降采样
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void reducePyramidCoordinates(const PyramidLevel &source, PyramidLevel &target)
+{
+	int rows = target.data.size(), cols = target.data[0].size();
+	target.startLongitude = source.startLongitude;
+	target.longitudeGridSpace = source.longitudeGridSpace * 2;
+	target.startLatitude = source.startLatitude;
+	target.latitudeGridSpace = source.latitudeGridSpace * 2;
+	const GridCoordinates *coordinates = source.options.coordinates;
+	target.coordinates = GridCoordinates();
+	if (coordinates == NULL)
+	{
+		return;
+	}
+	if (coordinates->xValues != NULL && coordinates->xValues->size() == source.data[0].size())
+	{
+		target.xValues.resize(cols);
+		for (int j = 0; j < cols; ++j)
+		{
+			target.xValues[j] = (*coordinates->xValues)[2 * j];
+		}
+		target.coordinates.xValues = &target.xValues;
+	}
+	if (coordinates->yValues != NULL && coordinates->yValues->size() == source.data.size())
+	{
+		target.yValues.resize(rows);
+		for (int i = 0; i < rows; ++i)
+		{
+			target.yValues[i] = (*coordinates->yValues)[2 * i];
+		}
+		target.coordinates.yValues = &target.yValues;
+	}
+	if (coordinates->nodeX != NULL && coordinates->nodeY != NULL && coordinates->nodeX->size() == source.data.size() &&
+		coordinates->nodeY->size() == source.data.size())
+	{
+		target.nodeX.resize(rows);
+		target.nodeY.resize(rows);
+		for (int i = 0; i < rows; ++i)
+		{
+			target.nodeX[i].resize(cols);
+			target.nodeY[i].resize(cols);
+			for (int j = 0; j < cols; ++j)
+			{
+				target.nodeX[i][j] = (*coordinates->nodeX)[2 * i][2 * j];
+				target.nodeY[i][j] = (*coordinates->nodeY)[2 * i][2 * j];
+			}
+		}
+		target.coordinates.nodeX = &target.nodeX;
+		target.coordinates.nodeY = &target.nodeY;
+	}
+}
+
+/************************************************************************/
+/* Funciton: calcLevelRange
+ * Description: 计算一层格点的最大最小值（不含缺测），有块索引时直接由块范围得到
+ * Input:
+	level: 金字塔的一层
+	data: 该层的格点数据
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void calcLevelRange(PyramidLevel &level, vector<vector<float> > &data)
+{
+	float minValue = FLT_MAX, maxValue = -FLT_MAX;
+	if (level.options.blockIndex != NULL)
+	{
+		const BlockRangeIndex &index = level.blockIndex;
+		int blocksNum = index.blockMin.size();
+		for (int k = 0; k < blocksNum; ++k)
+		{
+			minValue = index.blockMin[k] < minValue ? index.blockMin[k] : minValue;
+			maxValue = index.blockMax[k] > maxValue ? index.blockMax[k] : maxValue;
+		}
+	}
+	else
+	{
+		int rows = data.size(), cols = data[0].size();
+		for (int i = 0; i < rows; ++i)
+		{
+			for (int j = 0; j < cols; ++j)
+			{
+				float value = data[i][j];
+				if (isMissingValue(&level.options, value, (long long)i * cols + j))
+					continue;
+				minValue = value < minValue ? value : minValue;
+				maxValue = value > maxValue ? value : maxValue;
+			}
+		}
+	}
+	level.minGridValue = minValue;
+	level.maxGridValue = maxValue;
+}
+
+/************************************************************************/
+/* Funciton: doMarchingSquaresPyramid
+ * Description: 一次调用生成各层的降采样网格与等值线，每层使用doMarchingSquaresAccelerateTask计算；
+ *	网格小于2 × 2时停止，实际层数保存在pyramid.levelNum
+ * Input:
+	pyramid: 金字塔，各层的结果保存在pyramid.levels[k].pathLinesV，再次调用时复用其中的内存
+	data: 天气数据值二维数组（第0层）
+	isovalues: 等值线值数组，各层使用同一组等值
+	levelNum: 最多生成的层数（含第0层）
+	reduceMode: 降采样方式（PyramidReduce）
+	startLongitude: 起始经度（起始x坐标）
+	longitudeGridSpace: 经度间隔（x坐标间隔）
+	startLatitude: 起始纬度（起始y坐标）
+	latitudeGridSpace: 纬度间隔（y坐标间隔）
+	scheduler: 任务调度器，为NULL时使用默认的work-stealing线程池
+	options: 第0层的缺测值、格点坐标等可选设置，为NULL时不判断缺测并使用规则网格；
+		降采样后的各层缺测为NaN，不再使用fillValue和mask
+	blockSize: 块取值范围索引的块大小，大于0时为每层建立索引并用于跳过不含等值的块，为0时不建立；
+		pyramid.context.buildIndex为true时，各层等值线的空间索引保存在pyramid.levels[k].index
+ * Output: 实际生成的层数
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int doMarchingSquaresPyramid(ContourPyramid &pyramid, vector<vector<float> > &data, const vector<float> &isovalues, int levelNum,
+	int reduceMode, float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace,
+	TaskScheduler *scheduler = NULL, const ContourOptions *options = NULL, int blockSize = 0)
+{
+	if (scheduler == NULL)
+	{
+		scheduler = getDefaultScheduler();
+	}
+	pyramid.levelNum = 0;
+	if (levelNum <= 0 || data.size() < 2 || data[0].size() < 2)
+	{
+		return 0;
+	}
+	if ((int)pyramid.levels.size() < levelNum)
+	{
+		pyramid.levels.resize(levelNum);
+	}
+
+	for (int k = 0; k < levelNum; ++k)
+	{
+		PyramidLevel &level = pyramid.levels[k];
+		level.level = k;
+		if (k == 0)
+		{
+			level.step = 1;
+			level.data.clear();
+			level.startLongitude = startLongitude;
+			level.longitudeGridSpace = longitudeGridSpace;
+			level.startLatitude = startLatitude;
+			level.latitudeGridSpace = latitudeGridSpace;
+			level.options = options != NULL ? *options : ContourOptions();
+		}
+		else
+		{
+			PyramidLevel &previous = pyramid.levels[k - 1];
+			vector<vector<float> > &source = k == 1 ? data : previous.data;
+			if (source.size() < 3 || source[0].size() < 3)
+			{
+				break;
+			}
+			reducePyramidLevel(source, &previous.options, reduceMode, level.data, scheduler);
+			level.step = previous.step * 2;
+			reducePyramidCoordinates(previous, level);
+			level.options = ContourOptions();
+			level.options.checkNaN = true;
+			level.options.coordinates = previous.options.coordinates != NULL ? &level.coordinates : NULL;
+		}
+		vector<vector<float> > &levelData = k == 0 ? data : level.data;
+		level.stats = ContourStats();
+		level.options.stats = &level.stats;
+		level.options.blockIndex = NULL;
+		if (blockSize > 0)
+		{
+			buildBlockRangeIndex(levelData, blockSize, &level.options, level.blockIndex, scheduler);
+			level.options.blockIndex = &level.blockIndex;
+		}
+		calcLevelRange(level, levelData);
+
+		//结果与上下文交换，上一次调用中该层的链表结点回到上下文中复用
+		level.isovalues = isovalues;
+		doMarchingSquaresAccelerateTask(pyramid.context, levelData, level.isovalues, level.startLongitude, level.longitudeGridSpace,
+			level.startLatitude, level.latitudeGridSpace, level.maxGridValue, level.minGridValue, scheduler, &level.options);
+		level.pathLinesV.swap(pyramid.context.pathLinesV);
+		swap(level.index, pyramid.context.index);
+		pyramid.levelNum = k + 1;
+	}
+	return pyramid.levelNum;
+}
+
+}
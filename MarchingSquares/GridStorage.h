@@ -0,0 +1,269 @@
+﻿#pragma once
+#include <vector>
+#include <cmath>
+#include <cstring>
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: 压缩存储的格点数据：按int16、uint16、float16或float存放，实际值 = 存储值 * scale + offset。
+ *	等值线生成直接读取压缩数据，格点与等值的比较在存储值的比较域（整数）中进行，等值事先换算为比较域中的阈值；
+ *	只有鞍点判断、缺测判断和交点插值才把存储值还原为float，不需要预先展开整个数组。
+ *	vector< vector<float> >也提供同样的访问函数，等值线生成的各个函数对两种数据写法相同
+/************************************************************************/
+namespace marchingsquares
+{
+
+/**  半精度浮点数（IEEE 754 binary16）的存储类型 **/
+struct Float16
+{
+	unsigned short bits;
+};
+
+/************************************************************************/
+/* Funciton: halfToFloat
+ * Description: 半精度浮点数转换为float，支持F16C指令时直接使用指令转换
+ * Input:
+	bits: 半精度浮点数的二进制表示
+ * Output: float值
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static inline float halfToFloat(unsigned short bits)
+{
+#if defined(__F16C__)
+	return _cvtsh_ss(bits);
+#else
+	unsigned int sign = (unsigned int)(bits & 0x8000) << 16;
+	unsigned int exponent = (bits >> 10) & 0x1f;
+	unsigned int mantissa = bits & 0x3ff;
+	unsigned int result;
+	if (exponent == 0x1f)
+	{
+		result = sign | 0x7f800000 | (mantissa << 13);//无穷大或NaN
+	}
+	else if (exponent != 0)
+	{
+		result = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else
+	{
+		//0或非规格化数，值为mantissa * 2^-24
+		float value = mantissa * (1.0f / 16777216.0f);
+		return sign != 0 ? -value : value;
+	}
+	float value;
+	memcpy(&value, &result, sizeof(value));
+	return value;
+#endif
+}
+
+/************************************************************************/
+/* Funciton: floatToHalf
+ * Description: float转换为半精度浮点数（就近舍入，相等时取偶数），超出范围时为无穷大
+ * Input:
+	value: float值
+ * Output: 半精度浮点数的二进制表示
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static inline unsigned short floatToHalf(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+	unsigned short sign = (unsigned short)((bits >> 16) & 0x8000);
+	unsigned int absBits = bits & 0x7fffffff;
+	if (absBits > 0x7f800000)
+	{
+		return sign | 0x7e00;//NaN
+	}
+	if (absBits >= 0x47800000)
+	{
+		return sign | 0x7c00;//无穷大或超出范围
+	}
+	if (absBits < 0x38800000)
+	{
+		//结果为0或非规格化数，按2^-24为单位舍入
+		float absValue;
+		memcpy(&absValue, &absBits, sizeof(absValue));
+		return sign | (unsigned short)lrintf(absValue * 16777216.0f);
+	}
+	//指数由127偏移改为15偏移，尾数舍去低13位
+	unsigned int half = absBits - 0x38000000;
+	half = (half + 0xfff + ((half >> 13) & 1)) >> 13;
+	return sign | (unsigned short)half;
+}
+
+/**  各存储类型的换算：比较值（key）是与数值大小顺序一致的整数，fromKey为其逆变换 **/
+template<class T> struct GridStorage;
+
+template<> struct GridStorage<short>
+{
+	static const int MIN_KEY = -32768;
+	static const int MAX_KEY = 32767;
+	static float toFloat(short raw) { return raw; }
+	static int toKey(short raw) { return raw; }
+	static short fromKey(int key) { return (short)key; }
+};
+
+template<> struct GridStorage<unsigned short>
+{
+	static const int MIN_KEY = 0;
+	static const int MAX_KEY = 65535;
+	static float toFloat(unsigned short raw) { return raw; }
+	static int toKey(unsigned short raw) { return raw; }
+	static unsigned short fromKey(int key) { return (unsigned short)key; }
+};
+
+/* 半精度浮点数按符号和绝对值换算为比较值，正负0的比较值相同；
+ * NaN（不论符号）的比较值小于MIN_KEY，低于任何阈值，与float数据中NaN不满足 >= 等值的判断一致 */
+template<> struct GridStorage<Float16>
+{
+	static const int MIN_KEY = -0x7c00;
+	static const int MAX_KEY = 0x7c00;
+	static float toFloat(Float16 raw) { return halfToFloat(raw.bits); }
+	static int toKey(Float16 raw)
+	{
+		if ((raw.bits & 0x7fff) > 0x7c00)
+		{
+			return MIN_KEY - 1;//NaN
+		}
+		return (raw.bits & 0x8000) != 0 ? -(int)(raw.bits & 0x7fff) : (int)raw.bits;
+	}
+	static Float16 fromKey(int key)
+	{
+		Float16 raw;
+		raw.bits = key < 0 ? (unsigned short)(0x8000 | -key) : (unsigned short)key;
+		return raw;
+	}
+};
+
+template<> struct GridStorage<float>
+{
+	static float toFloat(float raw) { return raw; }
+};
+
+/**  按行存放的压缩格点数据，不持有内存；scale必须为正 **/
+template<class T>
+struct GridView
+{
+	const T *values;//第一个格点
+	int rows;//行数
+	int cols;//每行格点数
+	int rowStride;//相邻两行第一个格点的距离（元素个数）
+	float scale;//比例系数
+	float offset;//偏移量
+
+	GridView(const T *values, int rows, int cols, float scale = 1.0f, float offset = 0.0f, int rowStride = 0)
+		: values(values), rows(rows), cols(cols), rowStride(rowStride > 0 ? rowStride : cols), scale(scale), offset(offset) {}
+};
+
+/************************************************************************/
+/* 格点数据的访问函数：
+ *	getGridRows/getGridCols: 行数与每行格点数
+ *	getGridRow: 第i行第一个格点的存储值指针
+ *	dequantize: 存储值还原为实际值
+ *	getGridKey: 存储值在比较域中的值，与实际值的大小顺序一致
+ *	quantizeIsovalue: 等值在比较域中的阈值，比较值不小于阈值当且仅当实际值不小于等值
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static inline int getGridRows(const vector< vector<float> > &data)
+{
+	return data.size();
+}
+
+static inline int getGridCols(const vector< vector<float> > &data)
+{
+	return data.empty() ? 0 : data[0].size();
+}
+
+static inline const float *getGridRow(const vector< vector<float> > &data, int i)
+{
+	return &data[i][0];
+}
+
+static inline float dequantize(const vector< vector<float> > &, float raw)
+{
+	return raw;
+}
+
+static inline float getGridKey(const vector< vector<float> > &, float raw)
+{
+	return raw;
+}
+
+static inline float quantizeIsovalue(const vector< vector<float> > &, float isovalue)
+{
+	return isovalue;
+}
+
+template<class T>
+static inline int getGridRows(const GridView<T> &grid)
+{
+	return grid.rows;
+}
+
+template<class T>
+static inline int getGridCols(const GridView<T> &grid)
+{
+	return grid.cols;
+}
+
+template<class T>
+static inline const T *getGridRow(const GridView<T> &grid, int i)
+{
+	return grid.values + (size_t)i * grid.rowStride;
+}
+
+template<class T>
+static inline float dequantize(const GridView<T> &grid, T raw)
+{
+	return GridStorage<T>::toFloat(raw) * grid.scale + grid.offset;
+}
+
+template<class T>
+static inline float getGridKey(const GridView<T> &, T raw)
+{
+	return (float)GridStorage<T>::toKey(raw);
+}
+
+/* 实际值关于比较值单调不减，二分查找第一个实际值不小于等值的比较值，比较结果与先还原再比较完全一致 */
+template<class T>
+static float quantizeIsovalue(const GridView<T> &grid, float isovalue)
+{
+	int low = GridStorage<T>::MIN_KEY;
+	int high = GridStorage<T>::MAX_KEY + 1;
+	while (low < high)
+	{
+		int middle = low + (high - low) / 2;
+		if (dequantize(grid, GridStorage<T>::fromKey(middle)) >= isovalue)
+			high = middle;
+		else
+			low = middle + 1;
+	}
+	return (float)low;
+}
+
+/* float存储时比较值就是实际值 */
+static inline float getGridKey(const GridView<float> &grid, float raw)
+{
+	return dequantize(grid, raw);
+}
+
+static inline float quantizeIsovalue(const GridView<float> &, float isovalue)
+{
+	return isovalue;
+}
+
+template<class Grid>
+static inline float getGridValue(const Grid &data, int i, int j)
+{
+	return dequantize(data, getGridRow(data, i)[j]);
+}
+
+}
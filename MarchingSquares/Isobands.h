@@ -0,0 +1,537 @@
+﻿#pragma once
+#include <vector>
+#include <list>
+#include <cmath>
+#include <cfloat>
+#include <unordered_map>
+#include "IsolineTools.h"
+#include "TaskScheduler.h"
+#include "MarchingSquares.h"
+
+using namespace std;
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: Marching Squares 等值带（填充多边形）的实现
+ *	每个cell按三值（低于下界、位于等值带内、不低于上界）分为81种情况，
+ *	带内的边界由上下界等值线的线段与网格外边界组成，按顶点编号首尾相接拼成闭合环
+/************************************************************************/
+namespace marchingsquares
+{
+
+/* 等值带顶点编号 = 格点编号 * 8 + 顶点类型 */
+const int BAND_VERTEX_CORNER = 0;//格点本身
+const int BAND_VERTEX_I_LOW = 1;//(i,j)-(i+1,j)边与下界的交点
+const int BAND_VERTEX_I_HIGH = 2;//(i,j)-(i+1,j)边与上界的交点
+const int BAND_VERTEX_J_LOW = 3;//(i,j)-(i,j+1)边与下界的交点
+const int BAND_VERTEX_J_HIGH = 4;//(i,j)-(i,j+1)边与上界的交点
+
+/* 沿cell周边(i,j)->(i,j+1)->(i+1,j+1)->(i+1,j)逆时针遍历时，每条边对应的切点所在边的标号 */
+const int BandSideEdge[4] = { 1, 2, 3, 0 };
+
+/************************************************************************/
+/* Funciton: getBandVertexKey
+ * Description: 获得切点所在边上交点的全局编号，相邻cell共用的边得到相同的编号
+ * Input:
+	edgeIndex: 交点所在边在cell中的局部编号（0,1,2,3）
+	i: cell左上角点的数组x值下标
+	j: cell左上角点的数组y值下标
+	cols: 每行格点数
+	level: 0表示下界，1表示上界
+ * Output: 交点的全局编号
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static unsigned long long getBandVertexKey(int edgeIndex, int i, int j, int cols, int level)
+{
+	switch (edgeIndex)
+	{
+	case 0:
+		return ((unsigned long long)i * cols + j) * 8 + BAND_VERTEX_I_LOW + level;
+	case 1:
+		return ((unsigned long long)i * cols + j) * 8 + BAND_VERTEX_J_LOW + level;
+	case 2:
+		return ((unsigned long long)i * cols + j + 1) * 8 + BAND_VERTEX_I_LOW + level;
+	default:
+		return ((unsigned long long)(i + 1) * cols + j) * 8 + BAND_VERTEX_J_LOW + level;
+	}
+}
+
+/************************************************************************/
+/* Funciton: getBandVertexPoint
+ * Description: 由顶点编号计算顶点坐标，同一编号总是按相同方向插值
+ * Input:
+	key: 顶点编号
+	data: 天气数据值二维数组
+	lowValue: 等值带下界
+	highValue: 等值带上界
+	table: 格点坐标查找表
+ * Output: isotools::Point2D  返回该顶点的坐标
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static isotools::Point2D getBandVertexPoint(unsigned long long key, vector< vector< float > > &data, float lowValue, float highValue,
+	const CoordinateTable &table)
+{
+	int cols = data[0].size();
+	int type = (int)(key % 8);
+	int i = (int)(key / 8 / cols);
+	int j = (int)(key / 8 % cols);
+	switch (type)
+	{
+	case BAND_VERTEX_I_LOW:
+	case BAND_VERTEX_I_HIGH:
+		return VertexInterp(type == BAND_VERTEX_I_LOW ? lowValue : highValue, i + 1, j, data[i + 1][j], i, j, data[i][j],
+			table);
+	case BAND_VERTEX_J_LOW:
+	case BAND_VERTEX_J_HIGH:
+		return VertexInterp(type == BAND_VERTEX_J_LOW ? lowValue : highValue, i, j, data[i][j], i, j + 1, data[i][j + 1],
+			table);
+	default:
+		{
+			isotools::Point2D p;
+			p.x = table.getX(i, j);
+			p.y = table.getY(i, j);
+			return p;
+		}
+	}
+}
+
+/************************************************************************/
+/* Funciton: doIsobandCellCalc
+ * Description: 计算单个cell上等值带边界的有向线段（带内区域位于线段左侧），
+ *	cell内部的线段来自上下界的等值线，落在网格外边界或缺测区域边界上的线段来自cell的边；相邻cell共用的边不输出
+ * Input:
+	data: 天气数据值二维数组
+	i: cell左上角点的数组x值下标
+	j: cell左上角点的数组y值下标
+	lowValue: 等值带下界
+	highValue: 等值带上界
+	border: cell的四条边（按周边遍历顺序）是否位于网格外边界或与缺测cell相邻
+	segments: 返回有向线段（起点编号，终点编号）
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void doIsobandCellCalc(vector< vector< float > > &data, int i, int j, float lowValue, float highValue, const bool border[4],
+	vector< pair<unsigned long long, unsigned long long> > &segments)
+{
+	int cols = data[0].size();
+	float v[4] = { data[i][j], data[i][j + 1], data[i + 1][j + 1], data[i + 1][j] };
+
+	//三值分类：0低于下界，1位于带内，2不低于上界，共81种情况
+	int d[4];
+	int caseIndex = 0;
+	for (int k = 0; k < 4; ++k)
+	{
+		d[k] = (v[k] >= lowValue) + (v[k] >= highValue);
+		caseIndex = caseIndex * 3 + d[k];
+	}
+	if (caseIndex == 0 || caseIndex == 80)
+	{
+		return;//整个cell都在带外
+	}
+	if (caseIndex == 40 && !border[0] && !border[1] && !border[2] && !border[3])
+	{
+		return;//整个cell都在带内，且各边都与相邻cell共用
+	}
+
+	//上下界等值线在cell中的连接关系，与等值线使用相同的二义性处理
+	int partner[2][4] = { { -1, -1, -1, -1 }, { -1, -1, -1, -1 } };
+	for (int level = 0; level < 2; ++level)
+	{
+		int squareIndex = getSquareIndex(v[0], v[1], v[2], v[3], level == 0 ? lowValue : highValue);
+		for (int k = 0; SegmentTable[squareIndex][k] != -1; k = k + 2)
+		{
+			partner[level][SegmentTable[squareIndex][k]] = SegmentTable[squareIndex][k + 1];
+			partner[level][SegmentTable[squareIndex][k + 1]] = SegmentTable[squareIndex][k];
+		}
+	}
+
+	//沿cell周边逆时针收集带内的角点以及与上下界的交点
+	unsigned long long node[4] = { (unsigned long long)i * cols + j, (unsigned long long)i * cols + j + 1,
+		(unsigned long long)(i + 1) * cols + j + 1, (unsigned long long)(i + 1) * cols + j };
+	unsigned long long keys[12];
+	int edges[12], levels[12], sides[12];
+	bool exits[12];//是否为离开等值带的交点
+	int n = 0;
+	for (int s = 0; s < 4; ++s)
+	{
+		int a = d[s], b = d[(s + 1) % 4];
+		if (a == 1)
+		{
+			keys[n] = node[s] * 8 + BAND_VERTEX_CORNER;
+			edges[n] = -1;
+			levels[n] = -1;
+			exits[n] = false;
+			sides[n] = (s + 3) % 4;//到达该角点的线段位于上一条边
+			++n;
+		}
+		int e = BandSideEdge[s];
+		int crossLevels[2], crossNum = 0;
+		bool crossExits[2];
+		if (a < b)
+		{
+			if (a == 0) { crossLevels[crossNum] = 0; crossExits[crossNum++] = false; }
+			if (b == 2) { crossLevels[crossNum] = 1; crossExits[crossNum++] = true; }
+		}
+		else if (a > b)
+		{
+			if (a == 2) { crossLevels[crossNum] = 1; crossExits[crossNum++] = false; }
+			if (b == 0) { crossLevels[crossNum] = 0; crossExits[crossNum++] = true; }
+		}
+		for (int c = 0; c < crossNum; ++c)
+		{
+			keys[n] = getBandVertexKey(e, i, j, cols, crossLevels[c]);
+			edges[n] = e;
+			levels[n] = crossLevels[c];
+			exits[n] = crossExits[c];
+			sides[n] = s;
+			++n;
+		}
+	}
+
+	for (int t = 0; t < n; ++t)
+	{
+		//离开等值带的交点沿等值线连到进入等值带的交点
+		if (exits[t])
+		{
+			segments.push_back(make_pair(keys[t], getBandVertexKey(partner[levels[t]][edges[t]], i, j, cols, levels[t])));
+		}
+		//沿cell的边在带内前进的线段，只有位于网格外边界时才输出
+		int p = (t + n - 1) % n;
+		if (!exits[p] && border[sides[t]])
+		{
+			segments.push_back(make_pair(keys[p], keys[t]));
+		}
+	}
+}
+
+/************************************************************************/
+/* Funciton: getRingArea
+ * Description: 计算环的有向面积（逆时针为正）
+ * Input:
+	points: 环上所有的点，首尾不重复
+ * Output: 有向面积
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static double getRingArea(list<isotools::Point2D> &points)
+{
+	double area = 0;
+	list<isotools::Point2D>::iterator pIt = points.begin();
+	list<isotools::Point2D>::iterator pIt_end = points.end();
+	isotools::Point2D last = points.back();
+	for (; pIt != pIt_end; ++pIt)
+	{
+		area += (double)last.x * pIt->y - (double)pIt->x * last.y;
+		last = *pIt;
+	}
+	return area / 2;
+}
+
+/************************************************************************/
+/* Funciton: isPointInRing
+ * Description: 射线法判断点是否在环内
+ * Input:
+	point: 需要判断的点
+	points: 环上所有的点，首尾不重复
+ * Output: 在环内返回true，否则返回false
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static bool isPointInRing(isotools::Point2D point, list<isotools::Point2D> &points)
+{
+	bool inside = false;
+	list<isotools::Point2D>::iterator pIt = points.begin();
+	list<isotools::Point2D>::iterator pIt_end = points.end();
+	isotools::Point2D last = points.back();
+	for (; pIt != pIt_end; ++pIt)
+	{
+		if ((pIt->y > point.y) != (last.y > point.y) &&
+			point.x < (last.x - pIt->x) * (point.y - pIt->y) / (last.y - pIt->y) + pIt->x)
+		{
+			inside = !inside;
+		}
+		last = *pIt;
+	}
+	return inside;
+}
+
+/************************************************************************/
+/* Funciton: doIsobandLink
+ * Description: 将一个等值带所有的有向线段按顶点编号首尾相接拼成闭合环，区分外环与洞，并把洞归入包含它的最小外环
+ * Input:
+	segments: 各行区域生成的有向线段
+	data: 天气数据值二维数组
+	lowValue: 等值带下界
+	highValue: 等值带上界
+	isobands: 返回该等值带的所有多边形
+	table: 格点坐标查找表
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void doIsobandLink(vector< vector< pair<unsigned long long, unsigned long long> > > &segments, vector< vector< float > > &data,
+	float lowValue, float highValue, vector<isotools::Isoband> &isobands, const CoordinateTable &table)
+{
+	isobands.clear();
+	unordered_map<unsigned long long, unsigned long long> nextVertex;
+	int segmentsSize = 0;
+	int bandNum = segments.size();
+	for (int b = 0; b < bandNum; ++b)
+	{
+		segmentsSize += segments[b].size();
+	}
+	if (segmentsSize == 0)
+	{
+		return;
+	}
+	nextVertex.reserve(segmentsSize);
+	for (int b = 0; b < bandNum; ++b)
+	{
+		int size = segments[b].size();
+		for (int k = 0; k < size; ++k)
+		{
+			nextVertex[segments[b][k].first] = segments[b][k].second;
+		}
+	}
+
+	//数组下标坐标系中逆时针的环为外环；若输出坐标系相对数组下标镜像（如经纬度间隔异号），方向相反
+	double indexSign = table.orientation;
+	vector< list<isotools::Point2D> > holes;
+	vector<double> outerAreas;
+	vector<float> outerBox;//每个外环的包围盒 minX, minY, maxX, maxY
+
+	//按扫描顺序取环的起点，保证输出顺序稳定
+	for (int b = 0; b < bandNum; ++b)
+	{
+		int size = segments[b].size();
+		for (int k = 0; k < size; ++k)
+		{
+			unordered_map<unsigned long long, unsigned long long>::iterator it = nextVertex.find(segments[b][k].first);
+			if (it == nextVertex.end())
+			{
+				continue;//已经在其他环中
+			}
+			unsigned long long startKey = it->first;
+			unsigned long long currentKey = it->second;
+			nextVertex.erase(it);
+
+			list<isotools::Point2D> points;
+			points.push_back(getBandVertexPoint(startKey, data, lowValue, highValue, table));
+			while (currentKey != startKey)
+			{
+				isotools::Point2D point = getBandVertexPoint(currentKey, data, lowValue, highValue, table);
+				if (!(point == points.back()))
+				{
+					points.push_back(point);//交点与格点重合时去掉重复的点
+				}
+				it = nextVertex.find(currentKey);
+				if (it == nextVertex.end())
+				{
+					break;
+				}
+				currentKey = it->second;
+				nextVertex.erase(it);
+			}
+			if (points.size() > 1 && points.back() == points.front())
+			{
+				points.pop_back();
+			}
+			if (points.size() < 3)
+			{
+				continue;
+			}
+
+			double area = getRingArea(points);
+			if (area * indexSign > 0)
+			{
+				if (area < 0)
+				{
+					points.reverse();
+				}
+				isotools::Isoband isoband;
+				isoband.lowValue = lowValue;
+				isoband.highValue = highValue;
+				isoband.points.swap(points);
+				isobands.push_back(isoband);
+				outerAreas.push_back(fabs(area));
+				float box[4] = { FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX };
+				list<isotools::Point2D>::iterator pIt = isobands.back().points.begin();
+				list<isotools::Point2D>::iterator pIt_end = isobands.back().points.end();
+				for (; pIt != pIt_end; ++pIt)
+				{
+					if (pIt->x < box[0]) box[0] = pIt->x;
+					if (pIt->y < box[1]) box[1] = pIt->y;
+					if (pIt->x > box[2]) box[2] = pIt->x;
+					if (pIt->y > box[3]) box[3] = pIt->y;
+				}
+				outerBox.insert(outerBox.end(), box, box + 4);
+			}
+			else
+			{
+				if (area > 0)
+				{
+					points.reverse();
+				}
+				holes.push_back(list<isotools::Point2D>());
+				holes.back().swap(points);
+			}
+		}
+	}
+
+	//把每个洞归入包含它的面积最小的外环
+	int outerNum = isobands.size();
+	int holesNum = holes.size();
+	for (int h = 0; h < holesNum; ++h)
+	{
+		isotools::Point2D point = holes[h].front();
+		int best = -1;
+		for (int o = 0; o < outerNum; ++o)
+		{
+			if (point.x < outerBox[o * 4] || point.y < outerBox[o * 4 + 1] || point.x > outerBox[o * 4 + 2] || point.y > outerBox[o * 4 + 3])
+			{
+				continue;
+			}
+			if ((best == -1 || outerAreas[o] < outerAreas[best]) && isPointInRing(point, isobands[o].points))
+			{
+				best = o;
+			}
+		}
+		if (best != -1)
+		{
+			isobands[best].holes.push_back(list<isotools::Point2D>());
+			isobands[best].holes.back().swap(holes[h]);
+		}
+	}
+}
+
+/************************************************************************/
+/* Funciton: doMarchingSquaresIsoband 【此方法适用于 多核CPU，运行在可插拔的任务调度器上】
+ * Description: Marching Squares 等值带算法的实现，对相邻两个等值构成的每个[lo, hi)区间生成带洞的填充多边形
+ *	与等值线共用cell分类、按行划分的并行区域以及按交点编号拼接的方法
+ * Input:
+	data: 天气数据值二维数组
+	isovalues: 等值数组，必须依次递增，N个等值生成N-1个等值带
+	isobandsV: 返回每个等值带的所有多边形，isobandsV[k]对应区间[isovalues[k], isovalues[k+1])
+	startLongitude: 起始经度（起始x坐标）
+	longitudeGridSpace: 经度间隔（x坐标间隔）
+	startLatitude: 起始纬度（起始y坐标）
+	latitudeGridSpace: 纬度间隔（y坐标间隔）
+	maxGridValue: 网格点中的最大值
+	minGridValue: 网格点中的最小值
+	scheduler: 任务调度器，为NULL时使用默认的work-stealing线程池
+	options: 缺测值、格点坐标等可选设置，为NULL时不判断缺测并使用规则网格；有缺测角点的cell不属于任何等值带
+* Output: void
+* Author: gcdofree
+* Date: 2026.10.19
+/************************************************************************/
+static void doMarchingSquaresIsoband(vector<vector<float> > &data, vector<float> &isovalues, vector< vector<isotools::Isoband>> &isobandsV,
+	float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace, float maxGridValue, float minGridValue,
+	TaskScheduler *scheduler = NULL, const ContourOptions *options = NULL)
+{
+	if (scheduler == NULL)
+	{
+		scheduler = getDefaultScheduler();
+	}
+	isobandsV.clear();
+	int intervalNum = (int)isovalues.size() - 1;
+	if (intervalNum <= 0)
+	{
+		return;
+	}
+	isobandsV.resize(intervalNum);
+
+	int dataSize_i = data.size() - 1;
+	int dataSize_j = dataSize_i > 0 ? data[0].size() - 1 : 0;
+	if (dataSize_i <= 0 || dataSize_j <= 0)
+	{
+		return;
+	}
+
+	vector<int> bandStart;
+	int bandNum = getBandStart(dataSize_i, getTaskBandLimit(scheduler->getThreadNum(), intervalNum), bandStart);
+	CoordinateTable table;
+	buildCoordinateTable(data.size(), data[0].size(), startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace, options, table);
+
+	//第一步：按（行区域 × 等值带）生成有向线段
+	vector< vector< vector< pair<unsigned long long, unsigned long long> > > > segments(intervalNum,
+		vector< vector< pair<unsigned long long, unsigned long long> > >(bandNum));
+	vector< function<void()> > tasks;
+	for (int k = 0; k < intervalNum; ++k)
+	{
+		if (isovalues[k + 1] <= minGridValue || isovalues[k] > maxGridValue)
+		{
+			continue;//整个网格都不在该等值带内
+		}
+		for (int b = 0; b < bandNum; ++b)
+		{
+			tasks.push_back([&, k, b]()
+			{
+				float lowValue = isovalues[k], highValue = isovalues[k + 1];
+				//上一行、当前行、下一行每个cell的最大最小值，缺测cell的范围为空（最小值大于最大值）
+				vector<float> cellMin[3], cellMax[3];
+				for (int r = 0; r < 3; ++r)
+				{
+					cellMin[r].resize(dataSize_j);
+					cellMax[r].resize(dataSize_j);
+				}
+				int prevRow = 0, curRow = 1, nextRow = 2;
+				for (int i = bandStart[b]; i < bandStart[b + 1]; ++i)//逐行扫
+				{
+					if (options == NULL || i == bandStart[b])
+					{
+						calcRowRange(data, i, options, &cellMin[curRow][0], &cellMax[curRow][0]);
+						if (options != NULL && i > 0)
+							calcRowRange(data, i - 1, options, &cellMin[prevRow][0], &cellMax[prevRow][0]);
+					}
+					else
+					{
+						int temp = prevRow;
+						prevRow = curRow;
+						curRow = nextRow;
+						nextRow = temp;
+					}
+					if (options != NULL && i + 1 < dataSize_i)
+						calcRowRange(data, i + 1, options, &cellMin[nextRow][0], &cellMax[nextRow][0]);
+
+					for (int j = 0; j < dataSize_j; ++j)//逐列扫
+					{
+						//整个cell在带外（含缺测cell）时跳过
+						float minValue = cellMin[curRow][j], maxValue = cellMax[curRow][j];
+						if (maxValue < lowValue || minValue >= highValue)
+						{
+							continue;
+						}
+						//与网格外边界或缺测cell相邻的边需要输出
+						bool border[4] = {
+							i == 0 || (options != NULL && cellMin[prevRow][j] > cellMax[prevRow][j]),
+							j + 1 == dataSize_j || (options != NULL && cellMin[curRow][j + 1] > cellMax[curRow][j + 1]),
+							i + 1 == dataSize_i || (options != NULL && cellMin[nextRow][j] > cellMax[nextRow][j]),
+							j == 0 || (options != NULL && cellMin[curRow][j - 1] > cellMax[curRow][j - 1]) };
+						if (minValue >= lowValue && maxValue < highValue && !border[0] && !border[1] && !border[2] && !border[3])
+						{
+							continue;//整个cell都在带内部
+						}
+						doIsobandCellCalc(data, i, j, lowValue, highValue, border, segments[k][b]);
+					}
+				}
+			});
+		}
+	}
+	scheduler->runTasks(tasks);
+
+	//第二步：每个等值带独立拼接成环
+	tasks.clear();
+	for (int k = 0; k < intervalNum; ++k)
+	{
+		tasks.push_back([&, k]()
+		{
+			doIsobandLink(segments[k], data, isovalues[k], isovalues[k + 1], isobandsV[k], table);
+		});
+	}
+	scheduler->runTasks(tasks);
+}
+
+}
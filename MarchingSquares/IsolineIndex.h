@@ -0,0 +1,446 @@
+﻿#pragma once
+#include <vector>
+#include <list>
+#include <queue>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "IsolineTools.h"
+#include "TaskScheduler.h"
+
+using namespace std;
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: 等值线的空间索引：每条等值线按固定点数切成若干段，记录每段和每条等值线的外包矩形，
+ *	所有段的外包矩形按STR（Sort-Tile-Recursive）顺序批量装入紧凑的R树，节点连续存放，不再插入删除；
+ *	视口查询只访问与视口相交的节点，最近等值线查询按节点到查询点的距离优先搜索，只计算少数几段的点线距离
+/************************************************************************/
+namespace marchingsquares
+{
+
+const int INDEX_CHUNK_POINTS = 32;//每段最多的点数
+const int INDEX_NODE_SIZE = 16;//R树每个节点的子节点数
+
+/**  外包矩形 **/
+struct IsolineBox
+{
+	float minX;
+	float minY;
+	float maxX;
+	float maxY;
+
+	IsolineBox() : minX(FLT_MAX), minY(FLT_MAX), maxX(-FLT_MAX), maxY(-FLT_MAX) {}
+
+	void expand(float x, float y)
+	{
+		minX = x < minX ? x : minX;
+		minY = y < minY ? y : minY;
+		maxX = x > maxX ? x : maxX;
+		maxY = y > maxY ? y : maxY;
+	}
+
+	void expand(const IsolineBox &box)
+	{
+		minX = box.minX < minX ? box.minX : minX;
+		minY = box.minY < minY ? box.minY : minY;
+		maxX = box.maxX > maxX ? box.maxX : maxX;
+		maxY = box.maxY > maxY ? box.maxY : maxY;
+	}
+
+	bool intersects(const IsolineBox &box) const
+	{
+		return minX <= box.maxX && box.minX <= maxX && minY <= box.maxY && box.minY <= maxY;
+	}
+
+	/* 点到矩形的距离的平方，点在矩形内为0 */
+	float distance2(float x, float y) const
+	{
+		float dx = x < minX ? minX - x : (x > maxX ? x - maxX : 0);
+		float dy = y < minY ? minY - y : (y > maxY ? y - maxY : 0);
+		return dx * dx + dy * dy;
+	}
+};
+
+/**  等值线的一段：从first开始的pointNum个点，以及与下一段相接的点（构成环的最后一段接回首点） **/
+struct IsolineChunk
+{
+	IsolineBox box;//外包矩形，包含与下一段相接的点
+	int level;//等值编号
+	int line;//等值线编号
+	list<isotools::Point2D>::const_iterator first;//第一个点
+	int pointNum;//从first开始需要访问的点数（含与下一段相接的点）
+	bool isClosing;//是否还有一条从最后一个点回到closePoint的线段
+	isotools::Point2D closePoint;//构成环的等值线的首点
+};
+
+/**  等值线空间索引 **/
+struct IsolineIndex
+{
+	vector<IsolineChunk> chunks;//所有段，按STR顺序排列，即R树的叶子
+	vector< vector<IsolineBox> > nodeBoxes;//R树各层节点的外包矩形，nodeBoxes[0]为叶子节点，最后一层只有根节点
+	vector< vector<IsolineBox> > lineBoxes;//每条等值线的外包矩形，与pathLinesV一一对应
+	vector<int> chunkOffset;//建立时每条等值线的第一段的编号（按等值、等值线顺序连续编号）
+
+	void clear()
+	{
+		chunks.clear();
+		nodeBoxes.clear();
+		lineBoxes.clear();
+		chunkOffset.clear();
+	}
+};
+
+/************************************************************************/
+/* Funciton: getIsolineChunkNum
+ * Description: 一条等值线切分的段数
+ * Input:
+	pointNum: 等值线的点数
+ * Output: 段数，没有点时为0
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int getIsolineChunkNum(int pointNum)
+{
+	return pointNum <= 0 ? 0 : (pointNum + INDEX_CHUNK_POINTS - 1) / INDEX_CHUNK_POINTS;
+}
+
+/************************************************************************/
+/* Funciton: addIsolineChunks
+ * Description: 切分一条等值线并计算各段和整条线的外包矩形，不同等值线可以并行调用
+ * Input:
+	line: 等值线
+	m: 等值编号
+	n: 等值线编号
+	chunks: 写入的位置，需预留getIsolineChunkNum(点数)个
+	lineBox: 返回整条线的外包矩形
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void addIsolineChunks(const isotools::Isoline &line, int m, int n, IsolineChunk *chunks, IsolineBox &lineBox)
+{
+	lineBox = IsolineBox();
+	int pointNum = line.points.size();
+	int chunkNum = getIsolineChunkNum(pointNum);
+	list<isotools::Point2D>::const_iterator it = line.points.begin();
+	for (int c = 0; c < chunkNum; ++c)
+	{
+		IsolineChunk &chunk = chunks[c];
+		chunk.box = IsolineBox();
+		chunk.level = m;
+		chunk.line = n;
+		chunk.first = it;
+		int count = c == chunkNum - 1 ? pointNum - c * INDEX_CHUNK_POINTS : INDEX_CHUNK_POINTS;
+		for (int k = 0; k < count; ++k, ++it)
+		{
+			chunk.box.expand(it->x, it->y);
+		}
+		//与下一段共用边界上的点，保证两段之间的线段也在某一段内
+		chunk.pointNum = count;
+		if (it != line.points.end())
+		{
+			chunk.box.expand(it->x, it->y);
+			++chunk.pointNum;
+		}
+		chunk.isClosing = c == chunkNum - 1 && line.isCircle && pointNum > 2;
+		chunk.closePoint = line.points.front();
+		if (chunk.isClosing)
+		{
+			chunk.box.expand(chunk.closePoint.x, chunk.closePoint.y);
+		}
+		lineBox.expand(chunk.box);
+	}
+}
+
+/************************************************************************/
+/* Funciton: packIsolineIndex
+ * Description: 把所有段按STR顺序排列并逐层建立R树：先按中心x坐标分成若干竖条，
+ *	每个竖条内按中心y坐标排序（各竖条并行），再依次每INDEX_NODE_SIZE个合并为上一层的节点
+ * Input:
+	index: 已经填好chunks的索引
+	scheduler: 任务调度器，为NULL时使用默认的work-stealing线程池
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void packIsolineIndex(IsolineIndex &index, TaskScheduler *scheduler = NULL)
+{
+	vector<IsolineChunk> &chunks = index.chunks;
+	int chunkNum = chunks.size();
+	index.nodeBoxes.clear();
+	if (chunkNum == 0)
+	{
+		return;
+	}
+	sort(chunks.begin(), chunks.end(), [](const IsolineChunk &a, const IsolineChunk &b)
+	{
+		return a.box.minX + a.box.maxX < b.box.minX + b.box.maxX;
+	});
+	int leafNum = (chunkNum + INDEX_NODE_SIZE - 1) / INDEX_NODE_SIZE;
+	int sliceNum = (int)ceil(sqrt((double)leafNum));
+	int sliceSize = ((leafNum + sliceNum - 1) / sliceNum) * INDEX_NODE_SIZE;
+	sliceNum = (chunkNum + sliceSize - 1) / sliceSize;
+	parallelFor(scheduler, 0, sliceNum, 1, [&](int sliceBegin, int sliceEnd)
+	{
+		for (int s = sliceBegin; s < sliceEnd; ++s)
+		{
+			sort(chunks.begin() + s * sliceSize, chunks.begin() + min((s + 1) * sliceSize, chunkNum), [](const IsolineChunk &a, const IsolineChunk &b)
+			{
+				return a.box.minY + a.box.maxY < b.box.minY + b.box.maxY;
+			});
+		}
+	});
+
+	index.nodeBoxes.push_back(vector<IsolineBox>(leafNum));
+	for (int k = 0; k < chunkNum; ++k)
+	{
+		index.nodeBoxes[0][k / INDEX_NODE_SIZE].expand(chunks[k].box);
+	}
+	while (index.nodeBoxes.back().size() > 1)
+	{
+		const vector<IsolineBox> &children = index.nodeBoxes.back();
+		int childNum = children.size();
+		vector<IsolineBox> parents((childNum + INDEX_NODE_SIZE - 1) / INDEX_NODE_SIZE);
+		for (int k = 0; k < childNum; ++k)
+		{
+			parents[k / INDEX_NODE_SIZE].expand(children[k]);
+		}
+		index.nodeBoxes.push_back(parents);
+	}
+}
+
+/************************************************************************/
+/* Funciton: buildIsolineIndex
+ * Description: 为已经生成的等值线建立空间索引，各条等值线并行切分
+ * Input:
+	pathLinesV: 所有等值线的集合，索引引用其中的链表结点，等值线被修改后需要重新建立
+	index: 返回的索引
+	scheduler: 任务调度器，为NULL时使用默认的work-stealing线程池
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void buildIsolineIndex(const vector< vector<isotools::Isoline> > &pathLinesV, IsolineIndex &index, TaskScheduler *scheduler = NULL)
+{
+	if (scheduler == NULL)
+	{
+		scheduler = getDefaultScheduler();
+	}
+	int levelsNum = pathLinesV.size();
+	vector<int> lineOffset(levelsNum + 1, 0);
+	index.lineBoxes.resize(levelsNum);
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		lineOffset[m + 1] = lineOffset[m] + pathLinesV[m].size();
+		index.lineBoxes[m].resize(pathLinesV[m].size());
+	}
+	int linesNum = lineOffset[levelsNum];
+	index.chunkOffset.resize(linesNum + 1);
+	index.chunkOffset[0] = 0;
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		int levelLinesNum = pathLinesV[m].size();
+		for (int n = 0; n < levelLinesNum; ++n)
+		{
+			int k = lineOffset[m] + n;
+			index.chunkOffset[k + 1] = index.chunkOffset[k] + getIsolineChunkNum(pathLinesV[m][n].points.size());
+		}
+	}
+	index.chunks.resize(index.chunkOffset[linesNum]);
+	parallelFor(scheduler, 0, linesNum, linesNum / (scheduler->getThreadNum() * 8), [&](int lineBegin, int lineEnd)
+	{
+		int m = upper_bound(lineOffset.begin(), lineOffset.end(), lineBegin) - lineOffset.begin() - 1;
+		for (int k = lineBegin; k < lineEnd; ++k)
+		{
+			while (k >= lineOffset[m + 1])
+			{
+				++m;
+			}
+			int n = k - lineOffset[m];
+			addIsolineChunks(pathLinesV[m][n], m, n, &index.chunks[index.chunkOffset[k]], index.lineBoxes[m][n]);
+		}
+	});
+	packIsolineIndex(index, scheduler);
+}
+
+/************************************************************************/
+/* Funciton: queryIsolines
+ * Description: 查询与视口相交的等值线（按段的外包矩形判断），可以多个线程同时查询
+ * Input:
+	index: 空间索引
+	viewport: 视口范围
+	lines: 返回相交的等值线的(等值编号, 等值线编号)，升序且不重复
+ * Output: 相交的等值线数量
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int queryIsolines(const IsolineIndex &index, const IsolineBox &viewport, vector< pair<int, int> > &lines)
+{
+	lines.clear();
+	int depth = index.nodeBoxes.size();
+	if (depth == 0)
+	{
+		return 0;
+	}
+	//栈中保存(层, 节点编号)，从根节点向下
+	vector< pair<int, int> > stack;
+	stack.push_back(make_pair(depth - 1, 0));
+	int chunkNum = index.chunks.size();
+	while (!stack.empty())
+	{
+		int l = stack.back().first, k = stack.back().second;
+		stack.pop_back();
+		if (!index.nodeBoxes[l][k].intersects(viewport))
+		{
+			continue;
+		}
+		int childBegin = k * INDEX_NODE_SIZE;
+		if (l == 0)
+		{
+			int childEnd = min(childBegin + INDEX_NODE_SIZE, chunkNum);
+			for (int c = childBegin; c < childEnd; ++c)
+			{
+				if (index.chunks[c].box.intersects(viewport))
+				{
+					lines.push_back(make_pair(index.chunks[c].level, index.chunks[c].line));
+				}
+			}
+			continue;
+		}
+		int childEnd = min(childBegin + INDEX_NODE_SIZE, (int)index.nodeBoxes[l - 1].size());
+		for (int c = childBegin; c < childEnd; ++c)
+		{
+			stack.push_back(make_pair(l - 1, c));
+		}
+	}
+	sort(lines.begin(), lines.end());
+	lines.erase(unique(lines.begin(), lines.end()), lines.end());
+	return lines.size();
+}
+
+/************************************************************************/
+/* Funciton: getSegmentDistance2
+ * Description: 点到线段距离的平方
+ * Input:
+	x: 点的x坐标
+	y: 点的y坐标
+	a: 线段起点
+	b: 线段终点
+	nearest: 返回线段上最近的点
+ * Output: 距离的平方
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static float getSegmentDistance2(float x, float y, const isotools::Point2D &a, const isotools::Point2D &b, isotools::Point2D &nearest)
+{
+	float dx = b.x - a.x, dy = b.y - a.y;
+	float length2 = dx * dx + dy * dy;
+	float t = length2 > 0 ? ((x - a.x) * dx + (y - a.y) * dy) / length2 : 0;
+	t = t < 0 ? 0 : (t > 1 ? 1 : t);
+	nearest.x = a.x + t * dx;
+	nearest.y = a.y + t * dy;
+	return (x - nearest.x) * (x - nearest.x) + (y - nearest.y) * (y - nearest.y);
+}
+
+/************************************************************************/
+/* Funciton: findNearestIsoline
+ * Description: 查找离给定点最近的等值线，按节点外包矩形到点的距离由近及远搜索，
+ *	当前最近距离小于剩余节点的距离时结束；可以多个线程同时查询
+ * Input:
+	index: 空间索引
+	x: 点的x坐标
+	y: 点的y坐标
+	m: 返回最近等值线的等值编号
+	n: 返回最近等值线的编号
+	distance: 返回点到等值线的距离
+	nearest: 可选，返回等值线上最近的点
+ * Output: 索引为空时返回false
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static bool findNearestIsoline(const IsolineIndex &index, float x, float y, int &m, int &n, float &distance, isotools::Point2D *nearest = NULL)
+{
+	int depth = index.nodeBoxes.size();
+	if (depth == 0)
+	{
+		return false;
+	}
+	//队列中保存(距离的平方, (层, 节点编号))，层为-1表示段
+	typedef pair<float, pair<int, int> > QueueItem;
+	priority_queue< QueueItem, vector<QueueItem>, greater<QueueItem> > queue;
+	queue.push(make_pair(index.nodeBoxes[depth - 1][0].distance2(x, y), make_pair(depth - 1, 0)));
+	int chunkNum = index.chunks.size();
+	float bestDistance2 = FLT_MAX;
+	isotools::Point2D bestPoint, point;
+	while (!queue.empty() && queue.top().first < bestDistance2)
+	{
+		int l = queue.top().second.first, k = queue.top().second.second;
+		queue.pop();
+		if (l < 0)
+		{
+			const IsolineChunk &chunk = index.chunks[k];
+			list<isotools::Point2D>::const_iterator it = chunk.first;
+			isotools::Point2D previous = *it;
+			float chunkDistance2 = FLT_MAX;
+			if (chunk.pointNum == 1 && !chunk.isClosing)
+			{
+				chunkDistance2 = getSegmentDistance2(x, y, previous, previous, point);
+			}
+			for (int p = 1; p < chunk.pointNum; ++p)
+			{
+				++it;
+				isotools::Point2D candidate;
+				float d2 = getSegmentDistance2(x, y, previous, *it, candidate);
+				if (d2 < chunkDistance2)
+				{
+					chunkDistance2 = d2;
+					point = candidate;
+				}
+				previous = *it;
+			}
+			if (chunk.isClosing)
+			{
+				isotools::Point2D candidate;
+				float d2 = getSegmentDistance2(x, y, previous, chunk.closePoint, candidate);
+				if (d2 < chunkDistance2)
+				{
+					chunkDistance2 = d2;
+					point = candidate;
+				}
+			}
+			if (chunkDistance2 < bestDistance2)
+			{
+				bestDistance2 = chunkDistance2;
+				bestPoint = point;
+				m = chunk.level;
+				n = chunk.line;
+			}
+			continue;
+		}
+		int childBegin = k * INDEX_NODE_SIZE;
+		if (l == 0)
+		{
+			int childEnd = min(childBegin + INDEX_NODE_SIZE, chunkNum);
+			for (int c = childBegin; c < childEnd; ++c)
+			{
+				queue.push(make_pair(index.chunks[c].box.distance2(x, y), make_pair(-1, c)));
+			}
+			continue;
+		}
+		int childEnd = min(childBegin + INDEX_NODE_SIZE, (int)index.nodeBoxes[l - 1].size());
+		for (int c = childBegin; c < childEnd; ++c)
+		{
+			queue.push(make_pair(index.nodeBoxes[l - 1][c].distance2(x, y), make_pair(l - 1, c)));
+		}
+	}
+	distance = sqrt(bestDistance2);
+	if (nearest != NULL)
+	{
+		nearest->x = bestPoint.x;
+		nearest->y = bestPoint.y;
+	}
+	return true;
+}
+
+}
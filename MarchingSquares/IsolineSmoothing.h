@@ -0,0 +1,218 @@
+﻿#pragma once
+#include <vector>
+#include <list>
+#include <cmath>
+#include <algorithm>
+#include "IsolineTools.h"
+#include "TaskScheduler.h"
+#include "../CubicSplineInterpolation/CubicInterpolation.h"
+
+using namespace std;
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: 等值线平滑：按弦长参数化，对x(t)和y(t)分别拟合三次样条，再按目标间距重新采样
+ *	开放的等值线使用自然边界，构成环的等值线使用周期边界；
+ *	所有等值的所有等值线作为一组任务并行处理，结果直接写回原等值线
+/************************************************************************/
+namespace marchingsquares
+{
+
+const int SMOOTH_MAX_SAMPLES = 100000;//每条等值线最多的采样点数，防止间距过小
+
+/************************************************************************/
+/* Funciton: appendSmoothedRun
+ * Description: 对[begin, end)中的点按弦长参数化拟合样条并重新采样，结果追加到sx、sy；
+ *	点数少于3个时原样追加
+ * Input:
+	px: 点的x坐标（相邻点不重复，坐标都是有限值）
+	py: 点的y坐标
+	begin: 第一个点
+	end: 最后一个点之后
+	isCircle: 是否构成环（首尾不重复），环使用周期边界，否则使用自然边界并保留两个端点
+	spacing: 采样间距（与坐标同单位）
+	splineX: x(t)的样条，由调用者提供以便复用内存
+	splineY: y(t)的样条
+	sx: 追加采样点的x坐标
+	sy: 追加采样点的y坐标
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void appendSmoothedRun(const vector<float> &px, const vector<float> &py, int begin, int end, bool isCircle, float spacing,
+	CubicInterpolation &splineX, CubicInterpolation &splineY, vector<float> &sx, vector<float> &sy)
+{
+	int pointsNum = end - begin;
+	if (pointsNum < 3)
+	{
+		sx.insert(sx.end(), px.begin() + begin, px.begin() + end);
+		sy.insert(sy.end(), py.begin() + begin, py.begin() + end);
+		return;
+	}
+
+	//构成环时末尾再接上首点，作为周期样条的最后一个节点
+	vector<float> kx(px.begin() + begin, px.begin() + end), ky(py.begin() + begin, py.begin() + end);
+	if (isCircle)
+	{
+		kx.push_back(kx[0]);
+		ky.push_back(ky[0]);
+	}
+	int knotsNum = kx.size();
+	vector<float> t(knotsNum);
+	t[0] = 0;
+	for (int k = 1; k < knotsNum; ++k)
+	{
+		t[k] = t[k - 1] + sqrt((kx[k] - kx[k - 1]) * (kx[k] - kx[k - 1]) + (ky[k] - ky[k - 1]) * (ky[k] - ky[k - 1]));
+	}
+	float length = t[knotsNum - 1];
+
+	//x(t)与y(t)的节点相同，y(t)复制x(t)的分解后只重新计算系数
+	splineX.initVector(t, kx, 0, 0, knotsNum);
+	splineX.setBoundary(isCircle ? SPLINE_PERIODIC : SPLINE_NATURAL);
+	splineX.calcCoefs();
+	splineY = splineX;
+	splineY.refitY(ky);
+
+	//开放的等值线保留两个端点，环不重复首点
+	int segmentsNum = (int)ceil(length / spacing);
+	if (segmentsNum < (isCircle ? 3 : 1))
+		segmentsNum = isCircle ? 3 : 1;
+	if (segmentsNum > SMOOTH_MAX_SAMPLES)
+		segmentsNum = SMOOTH_MAX_SAMPLES;
+	int samplesNum = isCircle ? segmentsNum : segmentsNum + 1;
+	vector<float> ts(samplesNum), rx, ry;
+	for (int k = 0; k < samplesNum; ++k)
+	{
+		ts[k] = length * k / segmentsNum;
+	}
+	splineX.evaluate(ts, rx);
+	splineY.evaluate(ts, ry);
+	if (!isCircle)
+	{
+		//端点与原等值线完全一致，便于与其他图层拼接
+		rx[0] = kx[0];
+		ry[0] = ky[0];
+		rx[samplesNum - 1] = kx[pointsNum - 1];
+		ry[samplesNum - 1] = ky[pointsNum - 1];
+	}
+	sx.insert(sx.end(), rx.begin(), rx.end());
+	sy.insert(sy.end(), ry.begin(), ry.end());
+}
+
+/************************************************************************/
+/* Funciton: smoothIsoline
+ * Description: 平滑一条等值线，点数少于3个（去掉重复点后）的等值线保持不变；
+ *	不判断缺测时NaN格点旁会生成坐标为NaN的点，这些点保持不变，只平滑其间各段坐标有限的点
+ * Input:
+	line: 等值线，平滑后的点直接写回
+	spacing: 采样间距（与坐标同单位）
+	splineX: x(t)的样条，由调用者提供以便复用内存
+	splineY: y(t)的样条
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void smoothIsoline(isotools::Isoline &line, float spacing, CubicInterpolation &splineX, CubicInterpolation &splineY)
+{
+	//去掉相邻的重复点（交点与格点重合时会出现），保证参数严格递增
+	vector<float> px, py;
+	bool isFinite = true;
+	list<isotools::Point2D>::iterator it = line.points.begin();
+	list<isotools::Point2D>::iterator it_end = line.points.end();
+	for (; it != it_end; ++it)
+	{
+		if (px.empty() || it->x != px.back() || it->y != py.back())
+		{
+			px.push_back(it->x);
+			py.push_back(it->y);
+			isFinite = isFinite && std::isfinite(it->x) && std::isfinite(it->y);
+		}
+	}
+	if (line.isCircle && px.size() > 1 && px.back() == px.front() && py.back() == py.front())
+	{
+		px.pop_back();
+		py.pop_back();
+	}
+	int pointsNum = px.size();
+	if (pointsNum < 3 || spacing <= 0)
+	{
+		return;
+	}
+
+	vector<float> sx, sy;
+	if (isFinite)
+	{
+		appendSmoothedRun(px, py, 0, pointsNum, line.isCircle, spacing, splineX, splineY, sx, sy);
+	}
+	else
+	{
+		//按坐标不是有限值的点分段，各段作为开放的线分别平滑
+		int runBegin = 0;
+		for (int k = 0; k <= pointsNum; ++k)
+		{
+			if (k < pointsNum && std::isfinite(px[k]) && std::isfinite(py[k]))
+			{
+				continue;
+			}
+			appendSmoothedRun(px, py, runBegin, k, false, spacing, splineX, splineY, sx, sy);
+			if (k < pointsNum)
+			{
+				sx.push_back(px[k]);
+				sy.push_back(py[k]);
+			}
+			runBegin = k + 1;
+		}
+	}
+
+	line.points.clear();
+	isotools::resetIsolineMetrics(line);
+	int samplesNum = sx.size();
+	for (int k = 0; k < samplesNum; ++k)
+	{
+		isotools::Point2D p;
+		p.x = sx[k];
+		p.y = sy[k];
+		isotools::pushBackPoint(line, p);
+	}
+}
+
+/************************************************************************/
+/* Funciton: smoothIsolines
+ * Description: 并行平滑所有等值的所有等值线
+ * Input:
+	pathLinesV: 所有等值线的集合，平滑后的点直接写回
+	spacing: 采样间距（与坐标同单位）
+	scheduler: 任务调度器，为NULL时使用默认的work-stealing线程池
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void smoothIsolines(vector< vector<isotools::Isoline> > &pathLinesV, float spacing, TaskScheduler *scheduler = NULL)
+{
+	if (scheduler == NULL)
+	{
+		scheduler = getDefaultScheduler();
+	}
+	int levelsNum = pathLinesV.size();
+	vector<int> lineOffset(levelsNum + 1, 0);
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		lineOffset[m + 1] = lineOffset[m] + pathLinesV[m].size();
+	}
+	int linesNum = lineOffset[levelsNum];
+	parallelFor(scheduler, 0, linesNum, linesNum / (scheduler->getThreadNum() * 8), [&](int lineBegin, int lineEnd)
+	{
+		CubicInterpolation splineX, splineY;
+		int m = upper_bound(lineOffset.begin(), lineOffset.end(), lineBegin) - lineOffset.begin() - 1;
+		for (int n = lineBegin; n < lineEnd; ++n)
+		{
+			while (n >= lineOffset[m + 1])
+			{
+				++m;
+			}
+			smoothIsoline(pathLinesV[m][n - lineOffset[m]], spacing, splineX, splineY);
+		}
+	});
+}
+
+}
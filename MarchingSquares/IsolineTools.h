@@ -1,5 +1,8 @@
 ﻿#pragma once
 #include <list>
+#include <vector>
+#include <cmath>
+#include <cfloat>
 
 using namespace std;
 
@@ -16,6 +19,14 @@ namespace isotools
 		float y;//纵轴坐标值
 	};
 	
+	class Point3D
+	{
+	public:
+		float x;//x轴坐标值
+		float y;//y轴坐标值
+		float z;//z轴坐标值
+	};
+
 	/**  等值线数据结构，保存一条等值线 **/
 	struct Isoline
 	{
@@ -25,8 +36,220 @@ namespace isotools
 		list< Point2D > points;//该等值线上所有的点
 		Point2D startPoint;//该等值线 头结点 所在边的中点数组索引下标
 		Point2D endPoint;//该等值线 尾结点 所在边的中点数组索引下标
+		//以下属性在生成、拼接时随点的加入同步更新，不需要再遍历points
+		double length;//折线长度（不含环的闭合线段），与坐标同单位
+		double crossSum;//相邻两点叉积之和（不含环的闭合线段），用于计算环的面积
+		float minX;//外包矩形
+		float minY;
+		float maxX;
+		float maxY;
+
+		Isoline() : isovalue(0), isCircle(false), isBorder(false), startPoint(), endPoint(), length(0), crossSum(0),
+			minX(FLT_MAX), minY(FLT_MAX), maxX(-FLT_MAX), maxY(-FLT_MAX) {}
+	};
+
+	/**  等值带数据结构，保存一个填充多边形（外环及其内部的洞） **/
+	struct Isoband
+	{
+		float lowValue;//等值带的下界（包含）
+		float highValue;//等值带的上界（不包含）
+		list< Point2D > points;//外环上所有的点，逆时针方向，首尾不重复
+		vector< list< Point2D > > holes;//洞上所有的点，顺时针方向，首尾不重复
+	};
+
+	/**  等值面数据结构，保存一个共享顶点的三角网格 **/
+	struct TriangleMesh
+	{
+		float isovalue;//等值面的值
+		vector< Point3D > vertices;//所有顶点，相邻三角形共用同一个顶点
+		vector< int > indices;//每三个下标构成一个三角形，法向指向数值增大的一侧
 	};
 
+	/************************************************************************/
+	/* Funciton: expandBox
+	 * Description: 把一个点加入等值线的外包矩形
+	 * Author: gcdofree
+	 * Date: 2026.10.19
+	/************************************************************************/
+	static void expandBox(Isoline &line, const Point2D &point)
+	{
+		line.minX = point.x < line.minX ? point.x : line.minX;
+		line.minY = point.y < line.minY ? point.y : line.minY;
+		line.maxX = point.x > line.maxX ? point.x : line.maxX;
+		line.maxY = point.y > line.maxY ? point.y : line.maxY;
+	}
+
+	/************************************************************************/
+	/* Funciton: addSegmentMetrics
+	 * Description: 把线段a->b计入等值线的长度和叉积
+	 * Author: gcdofree
+	 * Date: 2026.10.19
+	/************************************************************************/
+	static void addSegmentMetrics(Isoline &line, const Point2D &a, const Point2D &b)
+	{
+		line.length += sqrt((double)(b.x - a.x) * (b.x - a.x) + (double)(b.y - a.y) * (b.y - a.y));
+		line.crossSum += (double)a.x * b.y - (double)b.x * a.y;
+	}
+
+	/************************************************************************/
+	/* Funciton: resetIsolineMetrics
+	 * Description: 清空等值线的长度、叉积和外包矩形
+	 * Author: gcdofree
+	 * Date: 2026.10.19
+	/************************************************************************/
+	static void resetIsolineMetrics(Isoline &line)
+	{
+		line.length = 0;
+		line.crossSum = 0;
+		line.minX = FLT_MAX;
+		line.minY = FLT_MAX;
+		line.maxX = -FLT_MAX;
+		line.maxY = -FLT_MAX;
+	}
+
+	/************************************************************************/
+	/* Funciton: pushBackPoint
+	 * Description: 在等值线尾部加入一个点，并更新长度、叉积和外包矩形
+	 * Input:
+		line: 等值线
+		point: 加入的点
+		freeNodes: 回收的空闲结点，不为空时从中取结点而不重新分配，为NULL时直接分配
+	 * Output: void
+	 * Author: gcdofree
+	 * Date: 2026.10.19
+	/************************************************************************/
+	static void pushBackPoint(Isoline &line, const Point2D &point, list< Point2D > *freeNodes = NULL)
+	{
+		if (!line.points.empty())
+		{
+			addSegmentMetrics(line, line.points.back(), point);
+		}
+		expandBox(line, point);
+		if (freeNodes != NULL && !freeNodes->empty())
+		{
+			line.points.splice(line.points.end(), *freeNodes, freeNodes->begin());
+			line.points.back() = point;
+		}
+		else
+		{
+			line.points.push_back(point);
+		}
+	}
+
+	/************************************************************************/
+	/* Funciton: pushFrontPoint
+	 * Description: 在等值线头部加入一个点，并更新长度、叉积和外包矩形
+	 * Input:
+		line: 等值线
+		point: 加入的点
+		freeNodes: 回收的空闲结点，不为空时从中取结点而不重新分配，为NULL时直接分配
+	 * Output: void
+	 * Author: gcdofree
+	 * Date: 2026.10.19
+	/************************************************************************/
+	static void pushFrontPoint(Isoline &line, const Point2D &point, list< Point2D > *freeNodes = NULL)
+	{
+		if (!line.points.empty())
+		{
+			addSegmentMetrics(line, point, line.points.front());
+		}
+		expandBox(line, point);
+		if (freeNodes != NULL && !freeNodes->empty())
+		{
+			line.points.splice(line.points.begin(), *freeNodes, freeNodes->begin());
+			line.points.front() = point;
+		}
+		else
+		{
+			line.points.push_front(point);
+		}
+	}
+
+	/************************************************************************/
+	/* Funciton: joinIsolineMetrics
+	 * Description: 两条等值线首尾相接时，由各自的属性直接得到相接后的属性，需在移动点之前调用；
+	 *	相接处的重复点长度和叉积均为0，是否去掉重复点不影响结果
+	 * Input:
+		target: 保留的等值线，属性更新为相接后的结果
+		source: 接到target上的等值线，两条线都不能为空
+		atFront: source接在target的头部（否则接在尾部）
+		reversed: source反向后再相接
+	 * Output: void
+	 * Author: gcdofree
+	 * Date: 2026.10.19
+	/************************************************************************/
+	static void joinIsolineMetrics(Isoline &target, const Isoline &source, bool atFront, bool reversed)
+	{
+		const Point2D &sourceFirst = reversed ? source.points.back() : source.points.front();
+		const Point2D &sourceLast = reversed ? source.points.front() : source.points.back();
+		//相接的线段
+		addSegmentMetrics(target, atFront ? sourceLast : target.points.back(), atFront ? target.points.front() : sourceFirst);
+		target.length += source.length;
+		target.crossSum += reversed ? -source.crossSum : source.crossSum;
+		target.minX = source.minX < target.minX ? source.minX : target.minX;
+		target.minY = source.minY < target.minY ? source.minY : target.minY;
+		target.maxX = source.maxX > target.maxX ? source.maxX : target.maxX;
+		target.maxY = source.maxY > target.maxY ? source.maxY : target.maxY;
+	}
+
+	/************************************************************************/
+	/* Funciton: calcIsolineMetrics
+	 * Description: 遍历所有点重新计算长度、叉积和外包矩形，用于直接修改了points的等值线
+	 * Input:
+		line: 等值线
+	 * Output: void
+	 * Author: gcdofree
+	 * Date: 2026.10.19
+	/************************************************************************/
+	static void calcIsolineMetrics(Isoline &line)
+	{
+		resetIsolineMetrics(line);
+		list<Point2D>::const_iterator it = line.points.begin();
+		list<Point2D>::const_iterator it_end = line.points.end();
+		const Point2D *previous = NULL;
+		for (; it != it_end; ++it)
+		{
+			if (previous != NULL)
+			{
+				addSegmentMetrics(line, *previous, *it);
+			}
+			expandBox(line, *it);
+			previous = &*it;
+		}
+	}
+
+	/************************************************************************/
+	/* Funciton: getIsolineLength
+	 * Description: 等值线的长度，构成环时包含闭合线段
+	 * Author: gcdofree
+	 * Date: 2026.10.19
+	/************************************************************************/
+	static double getIsolineLength(const Isoline &line)
+	{
+		if (!line.isCircle || line.points.size() < 2)
+		{
+			return line.length;
+		}
+		const Point2D &a = line.points.back(), &b = line.points.front();
+		return line.length + sqrt((double)(b.x - a.x) * (b.x - a.x) + (double)(b.y - a.y) * (b.y - a.y));
+	}
+
+	/************************************************************************/
+	/* Funciton: getIsolineArea
+	 * Description: 构成环的等值线所围的有向面积，逆时针（x向右、y向上）为正、顺时针为负；不构成环时为0
+	 * Author: gcdofree
+	 * Date: 2026.10.19
+	/************************************************************************/
+	static double getIsolineArea(const Isoline &line)
+	{
+		if (!line.isCircle || line.points.size() < 3)
+		{
+			return 0;
+		}
+		const Point2D &a = line.points.back(), &b = line.points.front();
+		return 0.5 * (line.crossSum + ((double)a.x * b.y - (double)b.x * a.y));
+	}
+
 	/**  等值线数据结构，保存一条初始的边 **/
 	struct Edge
 	{
@@ -34,7 +257,7 @@ namespace isotools
 		int edgeIndex2;//第二个交点
 		int i;//所在网格位置的横坐标
 		int j;//所在网格位置的纵坐标
-		int m;//对应的等值线值的index
+		int m;//对应的等值线值的index，-1表示该位置没有生成边
 		float isovalue;//对应的等值线值
 	};
 }
\ No newline at end of file
@@ -0,0 +1,595 @@
+﻿#pragma once
+#include <vector>
+#include <cmath>
+#include <unordered_map>
+#include "IsolineTools.h"
+#include "TaskScheduler.h"
+#include "MarchingSquares.h"
+
+using namespace std;
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: Marching Cubes 等值面的实现
+ *	体数据按z方向切分为若干slab，(slab, 等值)作为独立任务分类并生成三角形，
+ *	相邻三角形通过边编号哈希共用顶点，slab接缝处的顶点在合并时去重，输出带索引的三角网格
+/************************************************************************/
+namespace marchingcubes
+{
+
+const int CUBE_TRIANGLE_TABLE_WIDTH = 31;//三角形查找表每行的宽度，12个交点最多构成10个三角形，以-1结尾
+const int TASK_SLAB_MIN_LAYERS = 4;//每个slab至少包含的cell层数
+
+/* 立方体8个角点相对(x,y,z)的偏移，按Bourke的编号 */
+const int CubeCornerOffset[8][3] = {
+	{ 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 },
+	{ 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 }
+};
+
+/* 立方体12条边的两个角点，第一个角点是边的起点（坐标较小的一端） */
+const int CubeEdgeCorner[12][2] = {
+	{ 0, 1 }, { 1, 2 }, { 3, 2 }, { 0, 3 },
+	{ 4, 5 }, { 5, 6 }, { 7, 6 }, { 4, 7 },
+	{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+};
+
+/* 立方体6个面的角点，从立方体外侧看为逆时针方向 */
+const int CubeFaceCorner[6][4] = {
+	{ 0, 3, 2, 1 }, { 4, 5, 6, 7 }, { 0, 1, 5, 4 },
+	{ 3, 7, 6, 2 }, { 0, 4, 7, 3 }, { 1, 2, 6, 5 }
+};
+
+/**  三维体数据视图，x方向变化最快，格点(x,y,z)的值为data[(z * ny + y) * nx + x] **/
+struct VolumeView
+{
+	const float *data;//体数据，不拷贝
+	int nx;//x方向格点数
+	int ny;//y方向格点数
+	int nz;//z方向格点数
+	float startX;//起始x坐标
+	float spaceX;//x坐标间隔
+	float startY;//起始y坐标
+	float spaceY;//y坐标间隔
+	float startZ;//起始z坐标（如气压层或高度）
+	float spaceZ;//z坐标间隔
+
+	VolumeView() : data(NULL), nx(0), ny(0), nz(0), startX(0), spaceX(1), startY(0), spaceY(1), startZ(0), spaceZ(1) {}
+
+	float getValue(int x, int y, int z) const
+	{
+		return data[((long long)z * ny + y) * nx + x];
+	}
+};
+
+/**  Marching Cubes 查找表 **/
+struct CubeTables
+{
+	int edgeTable[256];//每种情况下与等值面相交的边，按位表示
+	int triTable[256][CUBE_TRIANGLE_TABLE_WIDTH];//每种情况下的三角形，每三个边编号构成一个三角形，以-1结尾
+};
+
+/************************************************************************/
+/* Funciton: getCubeEdgeIndex
+ * Description: 根据两个角点查找立方体的边编号
+ * Input:
+	corner1: 第一个角点
+	corner2: 第二个角点
+ * Output: 边编号，两个角点不相邻时返回-1
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int getCubeEdgeIndex(int corner1, int corner2)
+{
+	for (int e = 0; e < 12; ++e)
+	{
+		if ((CubeEdgeCorner[e][0] == corner1 && CubeEdgeCorner[e][1] == corner2) || (CubeEdgeCorner[e][0] == corner2 && CubeEdgeCorner[e][1] == corner1))
+		{
+			return e;
+		}
+	}
+	return -1;
+}
+
+/************************************************************************/
+/* Funciton: triangulateCubeLoop
+ * Description: 三角化立方体内的一个闭合环，内部的对角线不能连接同一个面上的两个交点：
+ *	二义性的面上有两段连线，若对角线连接这两段的端点，相邻立方体可能生成同一条有向边，网格不再是流形。
+ *	用区间动态规划找一个满足条件的三角化，三角形按环的逆序输出，使法向指向数值增大的一侧
+ * Input:
+	loop: 环上交点所在的边编号
+	loopNum: 环上交点数量
+	edgeFaces: 每条边所在的面，按位表示
+	triangle: 输出的三角形，每三个边编号构成一个三角形
+ * Output: 输出的边编号数量，找不到满足条件的三角化时返回-1
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int triangulateCubeLoop(const int *loop, int loopNum, const int *edgeFaces, int *triangle)
+{
+	//split[i][j]: 多边形loop[i..j]（以i-j为一条边）三角化时与i、j构成三角形的顶点，-1表示不能三角化
+	int split[12][12];
+	for (int len = 1; len < loopNum; ++len)
+	{
+		for (int i = 0; i + len < loopNum; ++i)
+		{
+			int j = i + len;
+			split[i][j] = -1;
+			if (len == 1)
+			{
+				split[i][j] = i;
+				continue;
+			}
+			for (int k = i + 1; k < j && split[i][j] < 0; ++k)
+			{
+				bool isValid1 = k == i + 1 || (split[i][k] >= 0 && (edgeFaces[loop[i]] & edgeFaces[loop[k]]) == 0);
+				bool isValid2 = k + 1 == j || (split[k][j] >= 0 && (edgeFaces[loop[k]] & edgeFaces[loop[j]]) == 0);
+				if (isValid1 && isValid2)
+				{
+					split[i][j] = k;
+				}
+			}
+		}
+	}
+	if (split[0][loopNum - 1] < 0)
+	{
+		return -1;
+	}
+
+	int triNum = 0;
+	int stack[24], stackNum = 0;
+	stack[stackNum++] = 0;
+	stack[stackNum++] = loopNum - 1;
+	while (stackNum > 0)
+	{
+		int j = stack[--stackNum], i = stack[--stackNum];
+		if (j - i < 2)
+		{
+			continue;
+		}
+		int k = split[i][j];
+		triangle[triNum++] = loop[i];
+		triangle[triNum++] = loop[j];
+		triangle[triNum++] = loop[k];
+		stack[stackNum++] = i;
+		stack[stackNum++] = k;
+		stack[stackNum++] = k;
+		stack[stackNum++] = j;
+	}
+	return triNum;
+}
+
+/************************************************************************/
+/* Funciton: buildCubeTables
+ * Description: 生成Marching Cubes查找表
+ *	在立方体每个面上按逆时针遍历，把每个进入交点（角点由外到内）与其后第一个离开交点相连，
+ *	即二义性的面总是把等值面内的角点分开；该规则只依赖面上的角点，相邻立方体在共享面上得到相同的连线，
+ *	因此生成的网格不会出现裂缝。每条交边在两个面上分别是进入点和离开点，沿连线即可得到闭合的环，
+ *	再用triangulateCubeLoop三角化，立方体内部的对角线不落在面上，相邻立方体不会共用内部的边
+ * Input:
+	tables: 输出的查找表
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void buildCubeTables(CubeTables &tables)
+{
+	int edgeFaces[12] = { 0 };
+	for (int f = 0; f < 6; ++f)
+	{
+		for (int k = 0; k < 4; ++k)
+		{
+			edgeFaces[getCubeEdgeIndex(CubeFaceCorner[f][k], CubeFaceCorner[f][(k + 1) % 4])] |= 1 << f;
+		}
+	}
+	for (int cubeIndex = 0; cubeIndex < 256; ++cubeIndex)
+	{
+		int next[12];
+		for (int e = 0; e < 12; ++e)
+		{
+			next[e] = -1;
+		}
+		int edgeFlags = 0;
+		for (int f = 0; f < 6; ++f)
+		{
+			int crossEdge[4], crossEnter[4], crossNum = 0;
+			for (int k = 0; k < 4; ++k)
+			{
+				int c1 = CubeFaceCorner[f][k], c2 = CubeFaceCorner[f][(k + 1) % 4];
+				bool inside1 = ((cubeIndex >> c1) & 1) != 0, inside2 = ((cubeIndex >> c2) & 1) != 0;
+				if (inside1 != inside2)
+				{
+					crossEdge[crossNum] = getCubeEdgeIndex(c1, c2);
+					crossEnter[crossNum] = inside2 ? 1 : 0;
+					++crossNum;
+				}
+			}
+			for (int k = 0; k < crossNum; ++k)
+			{
+				edgeFlags |= 1 << crossEdge[k];
+				if (crossEnter[k])//进入点与其后的离开点相连
+				{
+					next[crossEdge[k]] = crossEdge[(k + 1) % crossNum];
+				}
+			}
+		}
+		tables.edgeTable[cubeIndex] = edgeFlags;
+
+		//沿连线得到闭合环，逐个环三角化
+		int triNum = 0;
+		bool visited[12] = { false };
+		for (int e = 0; e < 12; ++e)
+		{
+			if (next[e] < 0 || visited[e])
+			{
+				continue;
+			}
+			int loop[12], loopNum = 0;
+			for (int cur = e; !visited[cur]; cur = next[cur])
+			{
+				visited[cur] = true;
+				loop[loopNum++] = cur;
+			}
+			//256种情况的每个环都能找到满足条件的三角化，tests/MarchingCubesTest检查生成的网格是有向流形
+			triNum += triangulateCubeLoop(loop, loopNum, edgeFaces, tables.triTable[cubeIndex] + triNum);
+		}
+		for (int k = triNum; k < CUBE_TRIANGLE_TABLE_WIDTH; ++k)
+		{
+			tables.triTable[cubeIndex][k] = -1;
+		}
+	}
+}
+
+/************************************************************************/
+/* Funciton: getCubeTables
+ * Description: 获得Marching Cubes查找表（首次调用时生成，C++11保证局部静态变量初始化线程安全）
+ * Output: 查找表
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static const CubeTables &getCubeTables()
+{
+	static CubeTables tables;
+	static bool isBuilt = (buildCubeTables(tables), true);
+	(void)isBuilt;
+	return tables;
+}
+
+/************************************************************************/
+/* Funciton: getCubeVertexKey
+ * Description: 获得立方体边上交点的全局编号 = 边起点格点编号 * 3 + 边的方向，相邻立方体共用的边得到相同的编号
+ * Input:
+	edgeIndex: 立方体边编号
+	x, y, z: 立方体角点0的下标
+	volume: 体数据视图
+ * Output: 交点的全局编号
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static long long getCubeVertexKey(int edgeIndex, int x, int y, int z, const VolumeView &volume)
+{
+	const int *c1 = CubeCornerOffset[CubeEdgeCorner[edgeIndex][0]];
+	const int *c2 = CubeCornerOffset[CubeEdgeCorner[edgeIndex][1]];
+	int axis = c2[0] != c1[0] ? 0 : (c2[1] != c1[1] ? 1 : 2);
+	long long node = ((long long)(z + c1[2]) * volume.ny + (y + c1[1])) * volume.nx + (x + c1[0]);
+	return node * 3 + axis;
+}
+
+/************************************************************************/
+/* Funciton: getCubeVertexPoint
+ * Description: 根据交点编号插值出交点坐标，总是从边的起点向终点插值，保证共用的边得到相同的结果
+ * Input:
+	key: 交点的全局编号
+	isovalue: 等值
+	volume: 体数据视图
+ * Output: 交点坐标
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static isotools::Point3D getCubeVertexPoint(long long key, float isovalue, const VolumeView &volume)
+{
+	int axis = (int)(key % 3);
+	long long node = key / 3;
+	int x = (int)(node % volume.nx);
+	int y = (int)((node / volume.nx) % volume.ny);
+	int z = (int)(node / ((long long)volume.nx * volume.ny));
+	float v1 = volume.getValue(x, y, z);
+	float v2 = volume.getValue(x + (axis == 0), y + (axis == 1), z + (axis == 2));
+	float mu = 0;
+	if (fabs(v1 - isovalue) >= marchingsquares::V_EPSILON)
+	{
+		mu = fabs(v2 - isovalue) < marchingsquares::V_EPSILON || fabs(v1 - v2) < marchingsquares::V_EPSILON ? 1 : (isovalue - v1) / (v2 - v1);
+	}
+
+	isotools::Point3D p;
+	p.x = (x + (axis == 0 ? mu : 0)) * volume.spaceX + volume.startX;
+	p.y = (y + (axis == 1 ? mu : 0)) * volume.spaceY + volume.startY;
+	p.z = (z + (axis == 2 ? mu : 0)) * volume.spaceZ + volume.startZ;
+	return p;
+}
+
+/**  一个(slab, 等值)任务生成的局部网格 **/
+struct SlabMesh
+{
+	vector< isotools::Point3D > vertices;//局部顶点
+	vector< long long > keys;//局部顶点对应的交点编号
+	vector< int > indices;//三角形的局部顶点下标
+	unordered_map< long long, int > keyIndex;//交点编号到局部顶点下标
+	vector< int > globalIndex;//局部顶点在本slab输出顶点中的下标，由上方slab输出的顶点记为-1-上方slab的局部下标
+	int ownNum;//本slab负责输出的顶点数量
+};
+
+/************************************************************************/
+/* Funciton: doSlabCalc
+ * Description: 分类一个slab内的所有立方体并生成三角形，slab内共用的顶点通过哈希去重
+ * Input:
+	volume: 体数据视图
+	zBegin: slab起始cell层
+	zEnd: slab结束cell层（不含）
+	isovalue: 等值
+	flip: 坐标系镜像时翻转三角形方向
+	options: 缺测值设置，可以为NULL
+	slab: 输出的局部网格
+ * Output: 处理的立方体数量
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static long long doSlabCalc(const VolumeView &volume, int zBegin, int zEnd, float isovalue, bool flip, const marchingsquares::ContourOptions *options, SlabMesh &slab)
+{
+	const CubeTables &tables = getCubeTables();
+	long long cellNum = 0;
+	for (int z = zBegin; z < zEnd; ++z)
+	{
+		for (int y = 0; y < volume.ny - 1; ++y)
+		{
+			for (int x = 0; x < volume.nx - 1; ++x)
+			{
+				int cubeIndex = 0;
+				bool isMissing = false;
+				for (int c = 0; c < 8; ++c)
+				{
+					int cx = x + CubeCornerOffset[c][0], cy = y + CubeCornerOffset[c][1], cz = z + CubeCornerOffset[c][2];
+					float value = volume.getValue(cx, cy, cz);
+					if (options != NULL && marchingsquares::isMissingValue(options, value, ((long long)cz * volume.ny + cy) * volume.nx + cx))
+					{
+						isMissing = true;
+						break;
+					}
+					if (value >= isovalue)
+					{
+						cubeIndex |= 1 << c;
+					}
+				}
+				++cellNum;
+				if (isMissing || tables.edgeTable[cubeIndex] == 0)
+				{
+					continue;
+				}
+
+				const int *triangle = tables.triTable[cubeIndex];
+				for (int k = 0; triangle[k] != -1; k += 3)
+				{
+					int triVertex[3];
+					for (int t = 0; t < 3; ++t)
+					{
+						long long key = getCubeVertexKey(triangle[k + t], x, y, z, volume);
+						unordered_map< long long, int >::iterator it = slab.keyIndex.find(key);
+						if (it != slab.keyIndex.end())
+						{
+							triVertex[t] = it->second;
+						}
+						else
+						{
+							triVertex[t] = slab.vertices.size();
+							slab.keyIndex[key] = triVertex[t];
+							slab.keys.push_back(key);
+							slab.vertices.push_back(getCubeVertexPoint(key, isovalue, volume));
+						}
+					}
+					slab.indices.push_back(triVertex[0]);
+					slab.indices.push_back(flip ? triVertex[2] : triVertex[1]);
+					slab.indices.push_back(flip ? triVertex[1] : triVertex[2]);
+				}
+			}
+		}
+	}
+	return cellNum;
+}
+
+/************************************************************************/
+/* Funciton: doMarchingCubes 【此方法适用于 多核CPU，运行在可插拔的任务调度器上】
+ * Description: 使用 Marching Cubes 算法生成等值面
+ *	1. 按z方向切分slab，(slab, 等值)作为独立任务分类立方体并生成局部网格
+ *	2. slab顶面上的顶点如果已由上方slab生成则复用，否则由本slab输出，随后按slab计算顶点偏移
+ *	3. 并行把局部网格写入每个等值对应的三角网格
+ * Input:
+	volume: 体数据视图
+	isovalues: 等值面值数组
+	meshes: 输出的三角网格，每个等值对应一个
+	maxValue: 体数据中的最大值
+	minValue: 体数据中的最小值
+	scheduler: 任务调度器，为NULL时使用默认线程池
+	options: 缺测值设置和统计输出，为NULL时不判断缺测
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void doMarchingCubes(const VolumeView &volume, vector<float> &isovalues, vector<isotools::TriangleMesh> &meshes, float maxValue, float minValue,
+	marchingsquares::TaskScheduler *scheduler = NULL, const marchingsquares::ContourOptions *options = NULL)
+{
+	if (scheduler == NULL)
+	{
+		scheduler = marchingsquares::getDefaultScheduler();
+	}
+	marchingsquares::ContourStats *stats = options != NULL ? options->stats : NULL;
+	double phaseTime = stats != NULL ? marchingsquares::getTimeMs() : 0;
+
+	//超出数据范围的等值不会生成等值面
+	vector<float> levels;
+	for (int m = 0; m < (int)isovalues.size(); ++m)
+	{
+		if (isovalues[m] >= minValue && isovalues[m] <= maxValue)
+		{
+			levels.push_back(isovalues[m]);
+		}
+	}
+	int levelsNum = levels.size();
+	meshes.clear();
+	meshes.resize(levelsNum);
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		meshes[m].isovalue = levels[m];
+	}
+	int layerNum = volume.nz - 1;
+	if (levelsNum == 0 || layerNum < 1 || volume.nx < 2 || volume.ny < 2)
+	{
+		return;
+	}
+
+	//slab数量随线程数变化，每个slab至少包含TASK_SLAB_MIN_LAYERS层cell
+	int slabNum = scheduler->getThreadNum() * 2;
+	if (slabNum > layerNum / TASK_SLAB_MIN_LAYERS)
+	{
+		slabNum = layerNum / TASK_SLAB_MIN_LAYERS;
+	}
+	if (slabNum < 1)
+	{
+		slabNum = 1;
+	}
+	vector<int> slabStart(slabNum + 1);
+	for (int s = 0; s <= slabNum; ++s)
+	{
+		slabStart[s] = (int)((long long)layerNum * s / slabNum);
+	}
+	bool flip = volume.spaceX * volume.spaceY * volume.spaceZ < 0;//坐标轴镜像时三角形方向相反
+
+	//分类并生成局部网格
+	vector<SlabMesh> slabs(slabNum * levelsNum);
+	vector<long long> slabCellNum(slabNum * levelsNum, 0);
+	vector< function<void()> > tasks;
+	for (int s = 0; s < slabNum; ++s)
+	{
+		for (int m = 0; m < levelsNum; ++m)
+		{
+			tasks.push_back([&, s, m]()
+			{
+				slabCellNum[s * levelsNum + m] = doSlabCalc(volume, slabStart[s], slabStart[s + 1], levels[m], flip, options, slabs[s * levelsNum + m]);
+			});
+		}
+	}
+	scheduler->runTasks(tasks);
+	if (stats != NULL)
+	{
+		double now = marchingsquares::getTimeMs();
+		stats->classifyTime = now - phaseTime;
+		phaseTime = now;
+	}
+
+	//slab顶面上的顶点由上方slab输出，上方slab没有生成（例如缺测）时仍由本slab输出
+	tasks.clear();
+	for (int s = 0; s < slabNum; ++s)
+	{
+		for (int m = 0; m < levelsNum; ++m)
+		{
+			tasks.push_back([&, s, m]()
+			{
+				SlabMesh &slab = slabs[s * levelsNum + m];
+				SlabMesh *upper = s + 1 < slabNum ? &slabs[(s + 1) * levelsNum + m] : NULL;
+				int verticesNum = slab.vertices.size();
+				slab.globalIndex.resize(verticesNum);
+				slab.ownNum = 0;
+				for (int v = 0; v < verticesNum; ++v)
+				{
+					long long key = slab.keys[v];
+					if (upper != NULL && key % 3 != 2 && key / 3 / ((long long)volume.nx * volume.ny) == slabStart[s + 1])
+					{
+						unordered_map< long long, int >::iterator it = upper->keyIndex.find(key);
+						if (it != upper->keyIndex.end())
+						{
+							slab.globalIndex[v] = -1 - it->second;//暂存上方slab的局部下标
+							continue;
+						}
+					}
+					slab.globalIndex[v] = slab.ownNum++;
+				}
+			});
+		}
+	}
+	scheduler->runTasks(tasks);
+	if (stats != NULL)
+	{
+		double now = marchingsquares::getTimeMs();
+		stats->stitchTime = now - phaseTime;
+		phaseTime = now;
+	}
+
+	//计算每个slab在输出中的顶点和下标偏移，然后并行写出
+	vector<int> vertexOffset(slabNum * levelsNum), indexOffset(slabNum * levelsNum);
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		int vertexSum = 0, indexSum = 0;
+		for (int s = 0; s < slabNum; ++s)
+		{
+			vertexOffset[s * levelsNum + m] = vertexSum;
+			indexOffset[s * levelsNum + m] = indexSum;
+			vertexSum += slabs[s * levelsNum + m].ownNum;
+			indexSum += slabs[s * levelsNum + m].indices.size();
+		}
+		meshes[m].vertices.resize(vertexSum);
+		meshes[m].indices.resize(indexSum);
+	}
+	tasks.clear();
+	for (int s = 0; s < slabNum; ++s)
+	{
+		for (int m = 0; m < levelsNum; ++m)
+		{
+			tasks.push_back([&, s, m]()
+			{
+				SlabMesh &slab = slabs[s * levelsNum + m];
+				isotools::TriangleMesh &mesh = meshes[m];
+				int base = vertexOffset[s * levelsNum + m];
+				int verticesNum = slab.vertices.size();
+				vector<int> outputIndex(verticesNum);
+				for (int v = 0; v < verticesNum; ++v)
+				{
+					int index = slab.globalIndex[v];
+					if (index >= 0)
+					{
+						mesh.vertices[base + index] = slab.vertices[v];
+						outputIndex[v] = base + index;
+					}
+					else//上方slab底面上的顶点一定由它自己输出，可以直接计算输出下标
+					{
+						outputIndex[v] = vertexOffset[(s + 1) * levelsNum + m] + slabs[(s + 1) * levelsNum + m].globalIndex[-1 - index];
+					}
+				}
+				int indexBase = indexOffset[s * levelsNum + m];
+				int indicesNum = slab.indices.size();
+				for (int k = 0; k < indicesNum; ++k)
+				{
+					mesh.indices[indexBase + k] = outputIndex[slab.indices[k]];
+				}
+			});
+		}
+	}
+	scheduler->runTasks(tasks);
+	if (stats != NULL)
+	{
+		double now = marchingsquares::getTimeMs();
+		stats->mergeTime = now - phaseTime;
+		stats->finishTime = 0;
+		stats->cellNum = 0;
+		stats->segmentNum = 0;
+		stats->outputNum = 0;
+		for (int k = 0; k < slabNum * levelsNum; ++k)
+		{
+			stats->cellNum += slabCellNum[k];
+			stats->segmentNum += slabs[k].indices.size() / 3;
+		}
+		for (int m = 0; m < levelsNum; ++m)
+		{
+			stats->outputNum += meshes[m].vertices.size();
+		}
+	}
+}
+
+}
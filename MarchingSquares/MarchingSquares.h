@@ -1,8 +1,15 @@
 ﻿#pragma once
 #include <vector>
 #include <cmath>
+#include <cfloat>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
 #include "IsolineTools.h"
+#include "TaskScheduler.h"
+#include "IsolineIndex.h"
+#include "GridStorage.h"
 
 using namespace std;
 /************************************************************************/ 
@@ -63,6 +70,223 @@ const int SegmentTable[ 16 ][ 5 ] = {
 
 const float V_EPSILON = 1.0f / 256.0f;//阈值，用来判断切点和格点的距离
 
+const int TASK_BAND_MIN_ROWS = 16;//任务并行版本中，每个拼接区域至少包含的行数
+const int TASK_STITCH_TASKS_PER_THREAD = 4;//任务并行版本中，等值较少时每个线程期望分到的（区域 × 等值）拼接任务数量
+const int EDGE_ID_LEVEL_SHIFT = 40;//边编号中等值编号所在的位置，低位为 格点编号 * 2 + 边的方向
+
+/**  并行驱动各阶段的统计信息（等值线与等值面共用） **/
+struct ContourStats
+{
+	double classifyTime;//分类阶段（生成cell上的短线段或三角形）耗时，毫秒
+	double stitchTime;//拼接阶段（连接线段或合并共享顶点）耗时，毫秒
+	double mergeTime;//合并阶段（区域接缝合并或写出结果）耗时，毫秒
+	double finishTime;//收尾阶段耗时，毫秒
+	long long cellNum;//处理的cell数量
+	long long segmentNum;//生成的线段或三角形数量
+	long long outputNum;//输出的等值线数量或顶点数量
+
+	ContourStats() : classifyTime(0), stitchTime(0), mergeTime(0), finishTime(0), cellNum(0), segmentNum(0), outputNum(0) {}
+};
+
+/**  网格坐标：规则经纬度网格之外，可以给出每列/每行的坐标（直线网格），或每个格点的坐标（曲线网格，如旋转极点、兰伯特投影网格） **/
+struct GridCoordinates
+{
+	const vector<float> *xValues;//每列格点的x坐标（经度），长度等于列数
+	const vector<float> *yValues;//每行格点的y坐标（纬度），长度等于行数
+	const vector< vector<float> > *nodeX;//每个格点的x坐标，与data大小相同；设置后忽略xValues和yValues
+	const vector< vector<float> > *nodeY;//每个格点的y坐标，与data大小相同
+
+	GridCoordinates() : xValues(NULL), yValues(NULL), nodeX(NULL), nodeY(NULL) {}
+};
+
+/**  按块统计的cell取值范围索引：每blockSize × blockSize个cell记录一个最小值和最大值（不含缺测cell），
+ *	不包含任何等值的块在生成阶段整块跳过；同一份数据多次生成等值线时可以共用；
+ *	范围是比较域中的值（见GridStorage.h），压缩存储的数据要用同样包装的数据建立 **/
+struct BlockRangeIndex
+{
+	int blockSize;//每块的cell行数和列数
+	int cellRows;//cell的行数（格点行数 - 1）
+	int cellCols;//cell的列数（格点列数 - 1）
+	int blockRows;//块的行数
+	int blockCols;//块的列数
+	vector<float> blockMin;//每块的最小值，按行优先存放，整块缺测时为FLT_MAX
+	vector<float> blockMax;//每块的最大值，整块缺测时为-FLT_MAX
+
+	BlockRangeIndex() : blockSize(0), cellRows(0), cellCols(0), blockRows(0), blockCols(0) {}
+
+	/* 块中是否有cell可能生成等值线 */
+	bool hasIsovalue(int bi, int bj, const vector<float> &isovalues) const
+	{
+		float minValue = blockMin[bi * blockCols + bj];
+		float maxValue = blockMax[bi * blockCols + bj];
+		int isovaluesNum = isovalues.size();
+		for (int m = 0; m < isovaluesNum; ++m)
+		{
+			if (isovalues[m] >= minValue && isovalues[m] <= maxValue)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+/**  鞍点（对角的两个格点不低于等值、另外两个低于等值）处的连接方式 **/
+enum SaddleRule
+{
+	SADDLE_CENTER = 0,//按cell中心值（四个格点的平均值）判断
+	SADDLE_JOIN_HIGH = 1,//高值区域在鞍点处连通（即SegmentTable中的连接方式）
+	SADDLE_JOIN_LOW = 2//低值区域在鞍点处连通
+};
+
+/**  等值线生成的可选设置 **/
+struct ContourOptions
+{
+	bool checkNaN;//NaN视为缺测
+	bool useFillValue;//等于fillValue的格点视为缺测
+	float fillValue;//缺测填充值，如9999
+	const vector<unsigned char> *mask;//可选的缺测位掩码，按行优先每个格点占一位，置1表示缺测，为NULL时不使用
+	ContourStats *stats;//可选的各阶段统计输出，为NULL时不统计
+	const GridCoordinates *coordinates;//可选的格点坐标，为NULL时使用起始经纬度和经纬度间隔
+	const BlockRangeIndex *blockIndex;//可选的块取值范围索引，须由同一份数据建立，为NULL时不跳过；目前由任务并行版本使用
+	int saddleRule;//鞍点处的连接方式（SaddleRule）；目前由任务并行版本使用，其他版本按中心值判断
+	bool snapToNode;//交点与格点的值相差小于V_EPSILON时取格点坐标；目前由任务并行版本使用，其他版本总是吸附
+
+	ContourOptions() : checkNaN(true), useFillValue(false), fillValue(9999), mask(NULL), stats(NULL), coordinates(NULL), blockIndex(NULL),
+		saddleRule(SADDLE_CENTER), snapToNode(true) {}
+};
+
+/************************************************************************/
+/* Funciton: getTimeMs
+ * Description: 获得单调递增的时间，用于统计各阶段耗时
+ * Output: 毫秒
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static double getTimeMs()
+{
+	return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**  格点坐标查找表，每次生成等值线前建立一次，插值时直接在输出坐标系中进行，不再逐点计算下标 * 间隔 + 起始值 **/
+struct CoordinateTable
+{
+	vector<float> xTable;//每列格点的x坐标
+	vector<float> yTable;//每行格点的y坐标
+	const vector< vector<float> > *nodeX;//曲线网格每个格点的x坐标，为NULL时使用xTable
+	const vector< vector<float> > *nodeY;//曲线网格每个格点的y坐标，为NULL时使用yTable
+	float orientation;//输出坐标系与数组下标坐标系（x为列，y为行）方向相同时为1，镜像时为-1
+
+	float getX(int i, int j) const
+	{
+		return nodeX != NULL ? (*nodeX)[i][j] : xTable[j];
+	}
+
+	float getY(int i, int j) const
+	{
+		return nodeY != NULL ? (*nodeY)[i][j] : yTable[i];
+	}
+};
+
+/************************************************************************/
+/* Funciton: buildCoordinateTable
+ * Description: 建立格点坐标查找表；options中的格点坐标与网格大小不一致时按规则网格处理
+ * Input:
+	rows: 行数
+	cols: 列数
+	startLongitude: 起始经度（起始x坐标）
+	longitudeGridSpace: 经度间隔（x坐标间隔）
+	startLatitude: 起始纬度（起始y坐标）
+	latitudeGridSpace: 纬度间隔（y坐标间隔）
+	options: 可选设置，为NULL或未设置coordinates时使用规则网格
+	table: 返回的坐标查找表
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void buildCoordinateTable(int rows, int cols, float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace,
+	const ContourOptions *options, CoordinateTable &table)
+{
+	const GridCoordinates *coordinates = options != NULL ? options->coordinates : NULL;
+	table.nodeX = NULL;
+	table.nodeY = NULL;
+	if (coordinates != NULL && coordinates->nodeX != NULL && coordinates->nodeY != NULL && rows > 1 && cols > 1 &&
+		(int)coordinates->nodeX->size() == rows && (int)coordinates->nodeY->size() == rows &&
+		(int)(*coordinates->nodeX)[0].size() == cols && (int)(*coordinates->nodeY)[0].size() == cols)
+	{
+		table.nodeX = coordinates->nodeX;
+		table.nodeY = coordinates->nodeY;
+		table.xTable.clear();
+		table.yTable.clear();
+		//用左上角cell的两条边判断方向
+		float dxj = table.getX(0, 1) - table.getX(0, 0), dyj = table.getY(0, 1) - table.getY(0, 0);
+		float dxi = table.getX(1, 0) - table.getX(0, 0), dyi = table.getY(1, 0) - table.getY(0, 0);
+		table.orientation = dxj * dyi - dyj * dxi < 0 ? -1.0f : 1.0f;
+		return;
+	}
+
+	if (coordinates != NULL && coordinates->xValues != NULL && (int)coordinates->xValues->size() == cols)
+	{
+		table.xTable = *coordinates->xValues;
+	}
+	else
+	{
+		table.xTable.resize(cols);
+		for (int j = 0; j < cols; ++j)
+		{
+			table.xTable[j] = j * longitudeGridSpace + startLongitude;
+		}
+	}
+	if (coordinates != NULL && coordinates->yValues != NULL && (int)coordinates->yValues->size() == rows)
+	{
+		table.yTable = *coordinates->yValues;
+	}
+	else
+	{
+		table.yTable.resize(rows);
+		for (int i = 0; i < rows; ++i)
+		{
+			table.yTable[i] = i * latitudeGridSpace + startLatitude;
+		}
+	}
+	float xDirection = cols > 1 ? table.xTable[cols - 1] - table.xTable[0] : longitudeGridSpace;
+	float yDirection = rows > 1 ? table.yTable[rows - 1] - table.yTable[0] : latitudeGridSpace;
+	table.orientation = (xDirection < 0) != (yDirection < 0) ? -1.0f : 1.0f;
+}
+
+/************************************************************************/
+/* Funciton: getSquareIndex
+ * Description: 计算cell的查找表下标，并通过中心点的值消除二义性（等值线与等值带共用）
+ * Input:
+	v8: cell左上角点(i,j)的值
+	v4: cell右上角点(i,j+1)的值
+	v2: cell右下角点(i+1,j+1)的值
+	v1: cell左下角点(i+1,j)的值
+	isovalue: 等值
+ * Output: EdgeTable/SegmentTable的下标
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int getSquareIndex(float v8, float v4, float v2, float v1, float isovalue)
+{
+	int squareIndex = 0;
+	if (v8 >= isovalue) squareIndex |= 8;
+	if (v4 >= isovalue) squareIndex |= 4;
+	if (v2 >= isovalue) squareIndex |= 2;
+	if (v1 >= isovalue) squareIndex |= 1;
+
+	//消除二义性
+	if (squareIndex == 5 || squareIndex == 10)// index = 0x5 或 0xa
+	{
+		float centerValue = (1 / 4.0) *(v8 + v4 + v2 + v1);
+		if (centerValue < isovalue)
+		{
+			squareIndex = 15 - squareIndex;//5与10互换
+		}
+	}
+	return squareIndex;
+}
+
 /************************************************************************/
 /* Funciton:   VertexInterp     
  * Description: 插值函数
@@ -107,6 +331,84 @@ static isotools::Point2D VertexInterp( float isovalue, int x1, int y1, float v1,
 
 	return p;
 }
+
+/************************************************************************/
+/* Funciton: VertexInterp
+ * Description: 插值函数，直接在坐标查找表给出的输出坐标系中插值，支持直线网格和曲线网格
+ * Input:
+	isovalue: 等值线值
+	x1: 第一个顶点的数组 x 下标
+	y1: 第一个顶点的数组 y 下标
+	v1:  第一个顶点值
+	x2: 第二个顶点的数组 x 下标
+	y2: 第二个顶点的数组 y 下标
+	v2:  第二个顶点值
+	table: 格点坐标查找表
+ * Output: 包含插值点的坐标及等值线值的Point2D对象
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static isotools::Point2D VertexInterp(float isovalue, int x1, int y1, float v1, int x2, int y2, float v2, const CoordinateTable &table)
+{
+	isotools::Point2D p;
+	p.x = table.getX(x1, y1);
+	p.y = table.getY(x1, y1);
+	if (fabs(v1 - isovalue) < V_EPSILON)
+	{
+		return p;
+	}
+	else if (fabs(v2 - isovalue) < V_EPSILON)
+	{
+		p.x = table.getX(x2, y2);
+		p.y = table.getY(x2, y2);
+		return p;
+	}
+
+	float mu = (isovalue - v1) / (v2 - v1);
+	p.x += mu * (table.getX(x2, y2) - p.x);
+	p.y += mu * (table.getY(x2, y2) - p.y);
+	return p;
+}
+
+/************************************************************************/
+/* Funciton: interpolateVertex
+ * Description: 与上面的VertexInterp相同，但是否吸附到格点、是否曲线网格在编译期确定，
+ *	插值时不再判断；Snap为true、Curvilinear与table.nodeX是否为NULL一致时结果与VertexInterp完全相同
+ * Input:
+	Snap: 交点与格点的值相差小于V_EPSILON时是否取格点坐标
+	Curvilinear: 是否曲线网格（table.nodeX与table.nodeY不为NULL）
+	其余参数同VertexInterp
+ * Output: 包含插值点的坐标及等值线值的Point2D对象
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<bool Snap, bool Curvilinear>
+static inline isotools::Point2D interpolateVertex(float isovalue, int x1, int y1, float v1, int x2, int y2, float v2, const CoordinateTable &table)
+{
+	isotools::Point2D p;
+	float x2Value = Curvilinear ? (*table.nodeX)[x2][y2] : table.xTable[y2];
+	float y2Value = Curvilinear ? (*table.nodeY)[x2][y2] : table.yTable[x2];
+	p.x = Curvilinear ? (*table.nodeX)[x1][y1] : table.xTable[y1];
+	p.y = Curvilinear ? (*table.nodeY)[x1][y1] : table.yTable[x1];
+	if (Snap)
+	{
+		if (fabs(v1 - isovalue) < V_EPSILON)
+		{
+			return p;
+		}
+		else if (fabs(v2 - isovalue) < V_EPSILON)
+		{
+			p.x = x2Value;
+			p.y = y2Value;
+			return p;
+		}
+	}
+
+	float mu = (isovalue - v1) / (v2 - v1);
+	p.x += mu * (x2Value - p.x);
+	p.y += mu * (y2Value - p.y);
+	return p;
+}
  
  /************************************************************************/
 /* Funciton:   getMiddlePoint     
@@ -148,34 +450,133 @@ static isotools::Point2D getMiddlePoint( int edgeIndex, int i,int j )
 
  /************************************************************************/
 /* Funciton: getCutPoint     
- * Description: 通过插值获得交点的坐标
+ * Description: 通过插值获得交点的坐标，竖直边总是由(i+1,j)向(i,j)插值，水平边总是由(i,j)向(i,j+1)插值，
+ *	相邻cell共用的边得到完全相同的结果
  * Input:
 	edgeIndex: 交点所在边在cell中的局部编号（0,1,2,3）
 	i:交点所在cell中左上角点的数组x值下标
 	j:交点所在cell中左上角点的数组y值下标
 	data:天气数据值二维数组
 	isovalue:等值
-	startLongitude: 起始经度（起始x坐标）
-	longitudeGridSpace: 经度间隔（x坐标间隔）
-	startLatitude: 起始纬度（起始y坐标）
-	latitudeGridSpace: 纬度间隔（y坐标间隔）
+	table: 格点坐标查找表
  * Output: isotools::Point2D  返回该交点的坐标
  * Author: gcdofree
  * Date: 2014.11.3
 /************************************************************************/
-static isotools::Point2D getCutPoint( int edgeIndex, int i, int j, vector< vector< float > > &data, float isovalue,
-	float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace )
+template<class Grid>
+static isotools::Point2D getCutPoint( int edgeIndex, int i, int j, const Grid &data, float isovalue, const CoordinateTable &table )
 {
 	switch( edgeIndex )
 	{
 	case 0:
-		return VertexInterp( isovalue, i + 1, j, data[ i + 1 ][ j ], i, j, data[ i ][ j ], startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace );
+		return VertexInterp( isovalue, i + 1, j, getGridValue( data, i + 1, j ), i, j, getGridValue( data, i, j ), table );
 	case 1:
-		return VertexInterp( isovalue, i, j, data[ i ][ j ], i, j + 1, data[ i ][ j + 1 ], startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace );
+		return VertexInterp( isovalue, i, j, getGridValue( data, i, j ), i, j + 1, getGridValue( data, i, j + 1 ), table );
 	case 2:
-		return VertexInterp( isovalue, i, j + 1, data[ i ][ j + 1 ], i + 1, j + 1, data[ i + 1 ][ j + 1 ], startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace );
-	case 3:
-		return VertexInterp( isovalue, i + 1, j + 1, data[ i + 1 ][ j + 1 ], i + 1, j, data[ i + 1 ][ j ], startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace );
+		return VertexInterp( isovalue, i + 1, j + 1, getGridValue( data, i + 1, j + 1 ), i, j + 1, getGridValue( data, i, j + 1 ), table );
+	default:
+		return VertexInterp( isovalue, i + 1, j, getGridValue( data, i + 1, j ), i + 1, j + 1, getGridValue( data, i + 1, j + 1 ), table );
+	}
+}
+
+/**  交点缓存：每个等值保存当前cell行的竖直边和上下两行水平边上已经插值的交点，相邻cell直接复用 **/
+struct CrossingCache
+{
+	vector< isotools::Point2D > rowPoints[2];//水平边(r,j)-(r,j+1)上的交点，按行号r的奇偶存放
+	vector< int > rowStamp[2];//rowPoints对应的行号，与r不相等表示尚未计算
+	vector< isotools::Point2D > columnPoints;//竖直边(i,j)-(i+1,j)上的交点
+	vector< int > columnStamp;//columnPoints对应的行号
+
+	void init(int cols)
+	{
+		for (int k = 0; k < 2; ++k)
+		{
+			rowPoints[k].resize(cols);
+			rowStamp[k].assign(cols, -1);
+		}
+		columnPoints.resize(cols);
+		columnStamp.assign(cols, -1);
+	}
+};
+
+/************************************************************************/
+/* Funciton: getCachedCutPoint
+ * Description: 通过交点缓存获得交点的坐标，每条边只插值一次
+ * Input:
+	edgeIndex: 交点所在边在cell中的局部编号（0,1,2,3）
+	i: 交点所在cell中左上角点的数组x值下标
+	j: 交点所在cell中左上角点的数组y值下标
+	data: 天气数据值二维数组
+	isovalue: 等值
+	table: 格点坐标查找表
+	cache: 该等值的交点缓存，为NULL时直接插值
+ * Output: isotools::Point2D  返回该交点的坐标
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static isotools::Point2D getCachedCutPoint(int edgeIndex, int i, int j, vector< vector< float > > &data, float isovalue, const CoordinateTable &table,
+	CrossingCache *cache)
+{
+	if (cache == NULL)
+	{
+		return getCutPoint(edgeIndex, i, j, data, isovalue, table);
+	}
+	//换算成边所在的格点：竖直边取上端点，水平边取左端点
+	bool isRowEdge = edgeIndex == 1 || edgeIndex == 3;
+	int r = edgeIndex == 3 ? i + 1 : i;
+	int c = edgeIndex == 2 ? j + 1 : j;
+	vector< isotools::Point2D > &points = isRowEdge ? cache->rowPoints[r & 1] : cache->columnPoints;
+	vector< int > &stamp = isRowEdge ? cache->rowStamp[r & 1] : cache->columnStamp;
+	if (stamp[c] != r)
+	{
+		points[c] = getCutPoint(isRowEdge ? 1 : 0, r, c, data, isovalue, table);
+		stamp[c] = r;
+	}
+	return points[c];
+}
+
+/************************************************************************/
+/* Funciton: moveIsolinePoints
+ * Description: 把source中的点整体接到target的头部或尾部，只修改链表链接，不重新分配结点，移动后source为空
+ * Input:
+	target: 保留的点链
+	toFront: true时接到target头部，false时接到target尾部
+	source: 被移动的点链
+	isReversed: 是否先把source反向
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void moveIsolinePoints(list<isotools::Point2D> &target, bool toFront, list<isotools::Point2D> &source, bool isReversed)
+{
+	if (isReversed)
+	{
+		source.reverse();
+	}
+	target.splice(toFront ? target.begin() : target.end(), source);
+}
+
+/************************************************************************/
+/* Funciton: dropIsolinePoint
+ * Description: 去掉点链头部或尾部的重复点，结点放回freeNodes供之后复用
+ * Input:
+	points: 点链，不能为空
+	isFront: true时去掉头结点，false时去掉尾结点
+	freeNodes: 回收的空闲结点，为NULL时直接释放
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void dropIsolinePoint(list<isotools::Point2D> &points, bool isFront, list<isotools::Point2D> *freeNodes)
+{
+	list<isotools::Point2D>::iterator pIt = isFront ? points.begin() : --points.end();
+	if (freeNodes != NULL)
+	{
+		freeNodes->splice(freeNodes->begin(), points, pIt);
+	}
+	else
+	{
+		points.erase(pIt);
 	}
 }
 
@@ -188,11 +589,13 @@ static isotools::Point2D getCutPoint( int edgeIndex, int i, int j, vector< vecto
 	pathLines: 等值线集合
 	m: 当前节点所在的等值线编号
 	pathlineHit: 当删除线段后，pathlineHit需要进行更新
+	freeNodes: 回收相接处重复点的结点，为NULL时直接释放
  * Output: 若有线段合并，则返回true，否则返回false
  * Author: gcdofree
  * Date: 2014.11.3
 /************************************************************************/
-static bool isMergeIsoLineAccelerate(isotools::Point2D mid, int type, vector<isotools::Isoline> &pathLines, int &m, vector<int> &pathlineHit)
+static bool isMergeIsoLineAccelerate(isotools::Point2D mid, int type, vector<isotools::Isoline> &pathLines, int &m, vector<int> &pathlineHit,
+	list<isotools::Point2D> *freeNodes = NULL)
 {
 	int pathlineSize = pathLines.size();
 
@@ -205,16 +608,9 @@ static bool isMergeIsoLineAccelerate(isotools::Point2D mid, int type, vector<iso
 			if (pathLines[m].points.size() > pathLines[i].points.size())//线段m较长，将i中的点移动到m中
 			{
 				// list不支持随机读取，不能通过下标访问
-				list<isotools::Point2D>::iterator pIt = pathLines[i].points.begin();//指向头结点
-				list<isotools::Point2D>::iterator pIt_end = pathLines[i].points.end();//指向头结点
-				++pIt;//跳过头结点
-				isotools::Point2D point;
-				while (pIt != pIt_end)
-				{
-					point = *pIt;//取值
-					pathLines[m].points.push_front(point);//在头部依次插入
-					++pIt;
-				}
+				isotools::joinIsolineMetrics(pathLines[m], pathLines[i], true, true);//相接处的重复点不加入，不影响长度和面积
+				dropIsolinePoint(pathLines[i].points, true, freeNodes);//跳过头结点
+				moveIsolinePoints(pathLines[m].points, true, pathLines[i].points, true);//反向后接到头部
 				//修改m的头结点
 				pathLines[m].startPoint = pathLines[i].endPoint;
 				pathLines.erase(pathLines.begin() + i);//删除线段pathLines[i]
@@ -237,16 +633,9 @@ static bool isMergeIsoLineAccelerate(isotools::Point2D mid, int type, vector<iso
 			}
 			else //线段i较长，将m中的点移动到i中
 			{
-				list<isotools::Point2D>::iterator pIt = pathLines[m].points.begin();//指向头结点
-				list<isotools::Point2D>::iterator pIt_end = pathLines[m].points.end();//指向头结点
-				++pIt;//跳过头结点
-				isotools::Point2D point;
-				while (pIt != pIt_end)
-				{
-					point = *pIt;//取值
-					pathLines[i].points.push_front(point);//在头部依次插入
-					++pIt;
-				}
+				isotools::joinIsolineMetrics(pathLines[i], pathLines[m], true, true);
+				dropIsolinePoint(pathLines[m].points, true, freeNodes);//跳过头结点
+				moveIsolinePoints(pathLines[i].points, true, pathLines[m].points, true);//反向后接到头部
 				//修改i的头结点
 				pathLines[i].startPoint = pathLines[m].endPoint;
 				pathLines.erase(pathLines.begin() + m);//删除线段pathLines[m]
@@ -279,20 +668,9 @@ static bool isMergeIsoLineAccelerate(isotools::Point2D mid, int type, vector<iso
 		{
 			if (pathLines[m].points.size() > pathLines[i].points.size())//线段m较长，将i中的点移动到m中
 			{
-				list<isotools::Point2D>::iterator pIt = pathLines[i].points.end();//指向尾结点
-				list<isotools::Point2D>::iterator pIt_beg = pathLines[i].points.begin();
-				--pIt;//跳过end
-				--pIt;//跳过尾结点
-				isotools::Point2D point;
-				while (pIt != pIt_beg)
-				{
-					point = *pIt;//取值
-					pathLines[m].points.push_back(point);//在尾部依次插入
-					--pIt;
-				}
-				//再push头结点
-				point = *pIt;//取值
-				pathLines[m].points.push_back(point);//在尾部插入
+				isotools::joinIsolineMetrics(pathLines[m], pathLines[i], false, true);
+				dropIsolinePoint(pathLines[i].points, false, freeNodes);//跳过尾结点
+				moveIsolinePoints(pathLines[m].points, false, pathLines[i].points, true);//反向后接到尾部
 				//修改m的尾结点
 				pathLines[m].endPoint = pathLines[i].startPoint;
 				pathLines.erase(pathLines.begin() + i);//删除线段pathLines[i]
@@ -314,20 +692,9 @@ static bool isMergeIsoLineAccelerate(isotools::Point2D mid, int type, vector<iso
 			}
 			else //线段i较长，将m中的点移动到i中
 			{
-				list<isotools::Point2D>::iterator pIt = pathLines[m].points.end();//指向尾结点
-				list<isotools::Point2D>::iterator pIt_beg = pathLines[m].points.begin();
-				--pIt;//跳过end
-				--pIt;//跳过尾结点
-				isotools::Point2D point;
-				while (pIt != pIt_beg)
-				{
-					point = *pIt;//取值
-					pathLines[i].points.push_back(point);//在尾部依次插入
-					--pIt;
-				}
-				//再push头结点
-				point = *pIt;//取值
-				pathLines[i].points.push_back(point);//在尾部插入
+				isotools::joinIsolineMetrics(pathLines[i], pathLines[m], false, true);
+				dropIsolinePoint(pathLines[m].points, false, freeNodes);//跳过尾结点
+				moveIsolinePoints(pathLines[i].points, false, pathLines[m].points, true);//反向后接到尾部
 				//修改i的尾结点
 				pathLines[i].endPoint = pathLines[m].startPoint;
 				pathLines.erase(pathLines.begin() + m);//删除线段pathLines[m]
@@ -359,16 +726,9 @@ static bool isMergeIsoLineAccelerate(isotools::Point2D mid, int type, vector<iso
 		else if (mid == pathLines[i].endPoint && type == 0)//m线的头结点与i的尾结点 重合，则将m加到i后
 		{
 			//将m中的点移动到i中
-			list<isotools::Point2D>::iterator pIt = pathLines[m].points.begin();//指向头结点
-			list<isotools::Point2D>::iterator pIt_end = pathLines[m].points.end();
-			++pIt;//跳过头结点
-			isotools::Point2D point;
-			while (pIt != pIt_end)
-			{
-				point = *pIt;//取值
-				pathLines[i].points.push_back(point);//在尾部依次插入
-				++pIt;
-			}
+			isotools::joinIsolineMetrics(pathLines[i], pathLines[m], false, false);
+			dropIsolinePoint(pathLines[m].points, true, freeNodes);//跳过头结点
+			moveIsolinePoints(pathLines[i].points, false, pathLines[m].points, false);//接到尾部
 			//修改i的尾结点
 			pathLines[i].endPoint = pathLines[m].endPoint;
 			pathLines.erase(pathLines.begin() + m);//删除线段pathLines[m]
@@ -399,16 +759,9 @@ static bool isMergeIsoLineAccelerate(isotools::Point2D mid, int type, vector<iso
 		else if (mid == pathLines[i].startPoint && type == 1)//m线的尾结点与i的头结点 重合，则将i加到m后
 		{
 			//将m中的点移动到i中
-			list<isotools::Point2D>::iterator pIt = pathLines[i].points.begin();//指向头结点
-			list<isotools::Point2D>::iterator pIt_end = pathLines[i].points.end();
-			++pIt;//跳过头结点
-			isotools::Point2D point;
-			while (pIt != pIt_end)
-			{
-				point = *pIt;//取值
-				pathLines[m].points.push_back(point);//在尾部依次插入
-				++pIt;
-			}
+			isotools::joinIsolineMetrics(pathLines[m], pathLines[i], false, false);
+			dropIsolinePoint(pathLines[i].points, true, freeNodes);//跳过头结点
+			moveIsolinePoints(pathLines[m].points, false, pathLines[i].points, false);//接到尾部
 			//修改m的头结点
 			pathLines[m].endPoint = pathLines[i].endPoint;
 			pathLines.erase(pathLines.begin() + i);//删除线段pathLines[i]
@@ -490,16 +843,16 @@ static void setHitTableAccelerate(int hitnum, int hitsize, vector< int > &pathLi
 	pathLinesHit: 等值对应的查找表
 	isovalue: 等值
 	pathLines: 返回该等值对应的各条等值线vector （每条保存在一个Isoline）
-	startLongitude: 起始经度（起始x坐标）
-	longitudeGridSpace: 经度间隔（x坐标间隔）
-	startLatitude: 起始纬度（起始y坐标）
-	latitudeGridSpace: 纬度间隔（y坐标间隔）
+	table: 格点坐标查找表
+	cache: 该等值的交点缓存，为NULL时每次直接插值
+	freeNodes: 回收的空闲结点，新加的点优先从中取结点，为NULL时直接分配
  * Output: void
  * Author: gcdofree
  * Date: 2014.11.3
 /************************************************************************/
 static void addPointToLineAccelerate(int edgeIndex1, int edgeIndex2, int i, int j, vector< vector< float > > &data, vector< int > &pathLinesHit,
-	float isovalue, vector< isotools::Isoline > &pathLines, float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace)
+	float isovalue, vector< isotools::Isoline > &pathLines, const CoordinateTable &table, CrossingCache *cache = NULL,
+	list<isotools::Point2D> *freeNodes = NULL)
 {
 	//判断当前边上的点是否与已有等值线的首尾点重合，若是，则忽略此重合点，再将另一个点插入到首或尾，否则，新增一条等值线
 	isotools::Point2D mid1 = getMiddlePoint(edgeIndex1, i, j);//存放数组索引
@@ -524,38 +877,38 @@ static void addPointToLineAccelerate(int edgeIndex1, int edgeIndex2, int i, int
 		else if (mid1 == pathLines[m].startPoint)//若m1与头结点重合
 		{
 			//则在头结点前插入另一个点，并更新头结点
-			isotools::Point2D point = getCutPoint(edgeIndex2, i, j, data, isovalue, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
-			pathLines[m].points.push_front(point);
+			isotools::Point2D point = getCachedCutPoint(edgeIndex2, i, j, data, isovalue, table, cache);
+			isotools::pushFrontPoint(pathLines[m], point, freeNodes);
 			pathLines[m].startPoint = mid2;
-			isMergeIsoLineAccelerate(mid2, 0, pathLines, m, pathLinesHit);//进行合并操作
+			isMergeIsoLineAccelerate(mid2, 0, pathLines, m, pathLinesHit, freeNodes);//进行合并操作
 			setHitTableAccelerate(m, hitSize, pathLinesHit);
 			return;
 		}
 		else if (mid1 == pathLines[m].endPoint)//若m1与尾结点重合
 		{
-			isotools::Point2D point = getCutPoint(edgeIndex2, i, j, data, isovalue, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
-			pathLines[m].points.push_back(point);
+			isotools::Point2D point = getCachedCutPoint(edgeIndex2, i, j, data, isovalue, table, cache);
+			isotools::pushBackPoint(pathLines[m], point, freeNodes);
 			pathLines[m].endPoint = mid2;
-			isMergeIsoLineAccelerate(mid2, 1, pathLines, m, pathLinesHit);//进行合并操作
+			isMergeIsoLineAccelerate(mid2, 1, pathLines, m, pathLinesHit, freeNodes);//进行合并操作
 			setHitTableAccelerate(m, hitSize, pathLinesHit);
 			return;
 		}
 		else if (mid2 == pathLines[m].startPoint)//若m2与头结点重合
 		{
 			//则在头结点前插入另一个点，并更新头结点
-			isotools::Point2D point = getCutPoint(edgeIndex1, i, j, data, isovalue, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
-			pathLines[m].points.push_front(point);
+			isotools::Point2D point = getCachedCutPoint(edgeIndex1, i, j, data, isovalue, table, cache);
+			isotools::pushFrontPoint(pathLines[m], point, freeNodes);
 			pathLines[m].startPoint = mid1;
-			isMergeIsoLineAccelerate(mid1, 0, pathLines, m, pathLinesHit);//进行合并操作
+			isMergeIsoLineAccelerate(mid1, 0, pathLines, m, pathLinesHit, freeNodes);//进行合并操作
 			setHitTableAccelerate(m, hitSize, pathLinesHit);
 			return;
 		}
 		else if (mid2 == pathLines[m].endPoint)//若m2与尾结点重合
 		{
-			isotools::Point2D point = getCutPoint(edgeIndex1, i, j, data, isovalue, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
-			pathLines[m].points.push_back(point);
+			isotools::Point2D point = getCachedCutPoint(edgeIndex1, i, j, data, isovalue, table, cache);
+			isotools::pushBackPoint(pathLines[m], point, freeNodes);
 			pathLines[m].endPoint = mid1;
-			isMergeIsoLineAccelerate(mid1, 1, pathLines, m, pathLinesHit);//进行合并操作
+			isMergeIsoLineAccelerate(mid1, 1, pathLines, m, pathLinesHit, freeNodes);//进行合并操作
 			setHitTableAccelerate(m, hitSize, pathLinesHit);
 			return;
 		}
@@ -580,171 +933,493 @@ static void addPointToLineAccelerate(int edgeIndex1, int edgeIndex2, int i, int
 		else if (mid1 == pathLines[m].startPoint)//若m1与头结点重合
 		{
 			//则在头结点前插入另一个点，并更新头结点
-			isotools::Point2D point = getCutPoint(edgeIndex2, i, j, data, isovalue, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
-			pathLines[m].points.push_front(point);
+			isotools::Point2D point = getCachedCutPoint(edgeIndex2, i, j, data, isovalue, table, cache);
+			isotools::pushFrontPoint(pathLines[m], point, freeNodes);
 			pathLines[m].startPoint = mid2;
-			isMergeIsoLineAccelerate(mid2, 0, pathLines, m, pathLinesHit);//进行合并操作
+			isMergeIsoLineAccelerate(mid2, 0, pathLines, m, pathLinesHit, freeNodes);//进行合并操作
 			setHitTableAccelerate(m, hitSize, pathLinesHit);
 			return;
 		}
 		else if (mid1 == pathLines[m].endPoint)//若m1与尾结点重合
 		{
-			isotools::Point2D point = getCutPoint(edgeIndex2, i, j, data, isovalue, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
-			pathLines[m].points.push_back(point);
+			isotools::Point2D point = getCachedCutPoint(edgeIndex2, i, j, data, isovalue, table, cache);
+			isotools::pushBackPoint(pathLines[m], point, freeNodes);
 			pathLines[m].endPoint = mid2;
-			isMergeIsoLineAccelerate(mid2, 1, pathLines, m, pathLinesHit);//进行合并操作
+			isMergeIsoLineAccelerate(mid2, 1, pathLines, m, pathLinesHit, freeNodes);//进行合并操作
 			setHitTableAccelerate(m, hitSize, pathLinesHit);
 			return;
 		}
 		else if (mid2 == pathLines[m].startPoint)//若m2与头结点重合
 		{
 			//则在头结点前插入另一个点，并更新头结点
-			isotools::Point2D point = getCutPoint(edgeIndex1, i, j, data, isovalue, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
-			pathLines[m].points.push_front(point);
+			isotools::Point2D point = getCachedCutPoint(edgeIndex1, i, j, data, isovalue, table, cache);
+			isotools::pushFrontPoint(pathLines[m], point, freeNodes);
 			pathLines[m].startPoint = mid1;
-			isMergeIsoLineAccelerate(mid1, 0, pathLines, m, pathLinesHit);//进行合并操作
+			isMergeIsoLineAccelerate(mid1, 0, pathLines, m, pathLinesHit, freeNodes);//进行合并操作
 			setHitTableAccelerate(m, hitSize, pathLinesHit);
 			return;
 		}
 		else if (mid2 == pathLines[m].endPoint)//若m2与尾结点重合
 		{
-			isotools::Point2D point = getCutPoint(edgeIndex1, i, j, data, isovalue, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
-			pathLines[m].points.push_back(point);
+			isotools::Point2D point = getCachedCutPoint(edgeIndex1, i, j, data, isovalue, table, cache);
+			isotools::pushBackPoint(pathLines[m], point, freeNodes);
 			pathLines[m].endPoint = mid1;
-			isMergeIsoLineAccelerate(mid1, 1, pathLines, m, pathLinesHit);//进行合并操作
+			isMergeIsoLineAccelerate(mid1, 1, pathLines, m, pathLinesHit, freeNodes);//进行合并操作
 			setHitTableAccelerate(m, hitSize, pathLinesHit);
 			return;
 		}
 	}//end for m
 	if (m == pathLinesSize)//说明这条边没有与任何一条等值线相接，则新创建一条等值线
 	{
-		isotools::Point2D point1 = getCutPoint(edgeIndex1, i, j, data, isovalue, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
-		isotools::Point2D point2 = getCutPoint(edgeIndex2, i, j, data, isovalue, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
+		isotools::Point2D point1 = getCachedCutPoint(edgeIndex1, i, j, data, isovalue, table, cache);
+		isotools::Point2D point2 = getCachedCutPoint(edgeIndex2, i, j, data, isovalue, table, cache);
 
-		isotools::Isoline isoList;
-		isoList.points.push_front(point1);
+		pathLines.push_back(isotools::Isoline());//新增一条等值线，直接在数组中构造，不再复制点链
+		isotools::Isoline &isoList = pathLines.back();
+		isotools::pushFrontPoint(isoList, point1, freeNodes);
 		isoList.startPoint = mid1;
-		isoList.points.push_back(point2);
+		isotools::pushBackPoint(isoList, point2, freeNodes);
 		isoList.endPoint = mid2;
 		isoList.isovalue = isovalue;
 		isoList.isCircle = false;
 		isoList.isBorder = false;
-		pathLines.push_back(isoList);//新增一条等值线
 	}
 }
 
 /************************************************************************/
-/* Funciton: doMarchingSquaresAccelerate 【普通CPU串行算法】
- * Description: Marching Squares 算法的实现
+/* Funciton: isMissingValue
+ * Description: 判断格点是否缺测
  * Input:
-	data: 天气数据值二维数组
-	isovalues: 等值线值数组
-	pathLinesV: 返回该等值数组下的所有各条等值线数组的集合
-	startLongitude: 起始经度（起始x坐标）
-	longitudeGridSpace: 经度间隔（x坐标间隔）
-	startLatitude: 起始纬度（起始y坐标）
-	latitudeGridSpace: 纬度间隔（y坐标间隔）
-	maxGridValue: 网格点中的最大值
-	minGridValue: 网格点中的最小值
-* Output: void
-* Author: gcdofree
-* Date: 2014.11.3
+	options: 缺测值设置，为NULL时不判断
+	value: 格点值
+	node: 格点按行优先的编号
+ * Output: 缺测返回true，否则返回false
+ * Author: gcdofree
+ * Date: 2026.10.19
 /************************************************************************/
-static void doMarchingSquaresAccelerate(vector<vector<float> > &data, vector<float> &isovalues, vector< vector<isotools::Isoline>> &pathLinesV,
-	float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace, float maxGridValue, float minGridValue)
+static bool isMissingValue(const ContourOptions *options, float value, long long node)
 {
+	if (options == NULL)
+	{
+		return false;
+	}
+	if (options->checkNaN && value != value)
+	{
+		return true;
+	}
+	if (options->useFillValue && value == options->fillValue)
+	{
+		return true;
+	}
+	if (options->mask != NULL && (long long)options->mask->size() > (node >> 3))
+	{
+		return (((*options->mask)[node >> 3] >> (node & 7)) & 1) != 0;
+	}
+	return false;
+}
 
-	pathLinesV.clear();
-
-	vector<vector<int>> pathLinesHit;
-
-	for (int m = 0; m < isovalues.size(); ++m)
+/************************************************************************/
+/* Funciton: isCellMissing
+ * Description: 判断cell是否有缺测的角点，网格范围外的cell不算缺测
+ * Input:
+	data: 天气数据值二维数组
+	i: cell左上角点的数组x值下标
+	j: cell左上角点的数组y值下标
+	options: 缺测值设置
+ * Output: 有缺测角点返回true，否则返回false
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<class Grid>
+static bool isCellMissing(const Grid &data, int i, int j, const ContourOptions *options)
+{
+	int cols = getGridCols(data);
+	if (options == NULL || i < 0 || j < 0 || i + 1 >= getGridRows(data) || j + 1 >= cols)
 	{
-		if (isovalues[m] < minGridValue || isovalues[m] > maxGridValue)
-		{
-			isovalues.erase(isovalues.begin() + m);//对vector进行增删元素后，begin，end，size会失效，必须即时调用
-			m--;
-		}
+		return false;
 	}
-	int isovaluesNum = isovalues.size();
-	pathLinesV.resize(isovaluesNum);
-	pathLinesHit.resize(isovaluesNum);
+	long long node0 = (long long)i * cols + j;
+	long long node1 = node0 + cols;
+	return isMissingValue(options, getGridValue(data, i, j), node0) || isMissingValue(options, getGridValue(data, i, j + 1), node0 + 1) ||
+		isMissingValue(options, getGridValue(data, i + 1, j + 1), node1 + 1) || isMissingValue(options, getGridValue(data, i + 1, j), node1);
+}
 
-	int dataSize_i = data.size() - 1;
-	for (int i = 0; i<dataSize_i; ++i)//逐行扫
+/************************************************************************/
+/* Funciton: calcRowRange
+ * Description: 预先算好一行中每个cell四个格点的最大最小值，缺测判断放在同一个循环中完成：
+ *	有缺测角点的cell范围置为空（最小值FLT_MAX，最大值-FLT_MAX），任何等值都会被跳过，不需要额外的遍历；
+ *	最大最小值是比较域中的值（见GridStorage.h），压缩存储的数据直接在存储值上比较
+ * Input:
+	data: 天气数据值二维数组
+	i: cell所在行
+	options: 缺测值设置，为NULL时不判断缺测
+	cellMin: 返回每个cell的最小值
+	cellMax: 返回每个cell的最大值
+	jBegin: 起始cell列
+	jEnd: 结束cell列（不含），小于0时到行末
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<class Grid>
+static void calcRowRange(const Grid &data, int i, const ContourOptions *options, float *cellMin, float *cellMax,
+	int jBegin = 0, int jEnd = -1)
+{
+	int cols = getGridCols(data);
+	int dataSize_j = jEnd < 0 ? cols - 1 : jEnd;
+	const auto *row0 = getGridRow(data, i);
+	const auto *row1 = getGridRow(data, i + 1);
+	bool checkNaN = options != NULL && options->checkNaN;
+	bool useFillValue = options != NULL && options->useFillValue;
+	float fillValue = options != NULL ? options->fillValue : 0;
+	const unsigned char *mask = options != NULL && options->mask != NULL && !options->mask->empty() ? &(*options->mask)[0] : NULL;
+	long long node0 = (long long)i * cols;
+	long long node1 = node0 + cols;
+	//掩码比网格短时，超出掩码的格点与isMissingValue相同按不缺测处理，逐个判断下标
+	long long maskSize = mask != NULL ? (long long)options->mask->size() : 0;
+	bool isMaskCovered = mask != NULL && ((node1 + cols - 1) >> 3) < maskSize;
+
+	for (int j = jBegin; j < dataSize_j; ++j)
 	{
-		int dataSize_j = data[i].size() - 1;
-		for (int j = 0; j<dataSize_j; ++j)//逐列扫
+		float a = getGridKey(data, row0[j]), b = getGridKey(data, row0[j + 1]), c = getGridKey(data, row1[j + 1]), d = getGridKey(data, row1[j]);
+		float minValue = a < b ? a : b;
+		float maxValue = a < b ? b : a;
+		minValue = c < minValue ? c : minValue;
+		maxValue = c > maxValue ? c : maxValue;
+		minValue = d < minValue ? d : minValue;
+		maxValue = d > maxValue ? d : maxValue;
+
+		bool missing = false;
+		if (checkNaN || useFillValue)
 		{
-
-			//预先算好邻域四个格点的最大最小值，避免重复计算squareIndexs[m]
-			float maxValue = 0, minValue = FLT_MAX;
-			if (data[i][j] >maxValue) maxValue = data[i][j];
-			if (data[i][j+1] >maxValue) maxValue = data[i][j+1];
-			if (data[i+1][j+1] >maxValue) maxValue = data[i+1][j+1];
-			if (data[i+1][j] >maxValue) maxValue = data[i+1][j];
-			if (data[i][j] < minValue) minValue = data[i][j];
-			if (data[i][j + 1] < minValue) minValue = data[i][j + 1];
-			if (data[i + 1][j + 1] < minValue) minValue = data[i + 1][j + 1];
-			if (data[i + 1][j] < minValue) minValue = data[i + 1][j];
-
-			for (int m = 0; m<isovaluesNum; ++m)
+			//缺测值按实际值判断
+			float va = dequantize(data, row0[j]), vb = dequantize(data, row0[j + 1]), vc = dequantize(data, row1[j + 1]), vd = dequantize(data, row1[j]);
+			missing = (checkNaN && (va != va || vb != vb || vc != vc || vd != vd)) ||
+				(useFillValue && (va == fillValue || vb == fillValue || vc == fillValue || vd == fillValue));
+		}
+		if (isMaskCovered)
+		{
+			missing = missing || ((mask[(node0 + j) >> 3] >> ((node0 + j) & 7)) & 1) || ((mask[(node0 + j + 1) >> 3] >> ((node0 + j + 1) & 7)) & 1) ||
+				((mask[(node1 + j) >> 3] >> ((node1 + j) & 7)) & 1) || ((mask[(node1 + j + 1) >> 3] >> ((node1 + j + 1) & 7)) & 1);
+		}
+		else if (mask != NULL)
+		{
+			long long nodes[4] = { node0 + j, node0 + j + 1, node1 + j, node1 + j + 1 };
+			for (int k = 0; k < 4 && !missing; ++k)
+			{
+				missing = (nodes[k] >> 3) < maskSize && ((mask[nodes[k] >> 3] >> (nodes[k] & 7)) & 1) != 0;
+			}
+		}
+		cellMin[j] = missing ? FLT_MAX : minValue;
+		cellMax[j] = missing ? -FLT_MAX : maxValue;
+	}
+}
+
+/************************************************************************/
+/* Funciton: buildBlockRangeIndex
+ * Description: 建立块取值范围索引，按块行并行
+ * Input:
+	data: 天气数据值二维数组
+	blockSize: 每块的cell行数和列数
+	options: 缺测值设置，为NULL时不判断缺测；缺测cell不计入块的范围
+	index: 返回的索引，范围是比较域中的值，只能用于同一种存储方式的数据
+	scheduler: 任务调度器，为NULL时使用默认的work-stealing线程池
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<class Grid>
+static void buildBlockRangeIndex(const Grid &data, int blockSize, const ContourOptions *options, BlockRangeIndex &index,
+	TaskScheduler *scheduler = NULL)
+{
+	int rows = getGridRows(data);
+	int cols = getGridCols(data);
+	index.blockSize = blockSize < 1 ? 1 : blockSize;
+	index.cellRows = rows > 1 ? rows - 1 : 0;
+	index.cellCols = index.cellRows > 0 && cols > 1 ? cols - 1 : 0;
+	index.blockRows = (index.cellRows + index.blockSize - 1) / index.blockSize;
+	index.blockCols = (index.cellCols + index.blockSize - 1) / index.blockSize;
+	index.blockMin.assign(index.blockRows * index.blockCols, FLT_MAX);
+	index.blockMax.assign(index.blockRows * index.blockCols, -FLT_MAX);
+	parallelFor(scheduler, 0, index.blockRows, 1, [&](int blockBegin, int blockEnd)
+	{
+		vector<float> cellMin(index.cellCols), cellMax(index.cellCols);
+		for (int bi = blockBegin; bi < blockEnd; ++bi)
+		{
+			float *blockMin = &index.blockMin[bi * index.blockCols];
+			float *blockMax = &index.blockMax[bi * index.blockCols];
+			int rowEnd = min((bi + 1) * index.blockSize, index.cellRows);
+			for (int i = bi * index.blockSize; i < rowEnd; ++i)
+			{
+				calcRowRange(data, i, options, cellMin.data(), cellMax.data());
+				for (int j = 0; j < index.cellCols; ++j)
+				{
+					int bj = j / index.blockSize;
+					blockMin[bj] = cellMin[j] < blockMin[bj] ? cellMin[j] : blockMin[bj];
+					blockMax[bj] = cellMax[j] > blockMax[bj] ? cellMax[j] : blockMax[bj];
+				}
+			}
+		}
+	});
+}
+
+/************************************************************************/
+/* Funciton: isMaskBorderPoint
+ * Description: 判断等值线端点所在的边是否与缺测cell相邻
+ * Input:
+	mid: 端点所在边的中点（数组索引）
+	data: 天气数据值二维数组
+	options: 缺测值设置
+ * Output: 与缺测cell相邻返回true，否则返回false
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<class Grid>
+static bool isMaskBorderPoint(isotools::Point2D mid, const Grid &data, const ContourOptions *options)
+{
+	int i = (int)floor(mid.x);
+	int j = (int)floor(mid.y);
+	if (mid.x != i)//(i,j)-(i+1,j)边，相邻cell为(i,j-1)与(i,j)
+	{
+		return isCellMissing(data, i, j - 1, options) || isCellMissing(data, i, j, options);
+	}
+	//(i,j)-(i,j+1)边，相邻cell为(i-1,j)与(i,j)
+	return isCellMissing(data, i - 1, j, options) || isCellMissing(data, i, j, options);
+}
+
+/************************************************************************/
+/* Funciton: finishIsolines
+ * Description: 拼接完成后的处理：止于缺测区域的等值线标记为边界线，其余首尾近似相连的等值线标记为环
+ * Input:
+	data: 天气数据值二维数组
+	pathLinesV: 所有等值线的集合
+	options: 缺测值设置，为NULL时不判断缺测
+	checkClosure: 是否按首尾近似相连判断环；按边编号精确拼接时不需要
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<class Grid>
+static void finishIsolines(const Grid &data, vector< vector<isotools::Isoline>> &pathLinesV, const ContourOptions *options, bool checkClosure = true)
+{
+	int pathLinesV_i = pathLinesV.size();
+	for (int i = 0; i < pathLinesV_i; ++i)
+	{
+		int pathLinesV_j = pathLinesV[i].size();
+		for (int j = 0; j < pathLinesV_j; ++j)
+		{
+			if (options != NULL && !pathLinesV[i][j].isCircle &&
+				(isMaskBorderPoint(pathLinesV[i][j].startPoint, data, options) || isMaskBorderPoint(pathLinesV[i][j].endPoint, data, options)))
+			{
+				//止于缺测区域边界，不能按近似首尾相连处理
+				pathLinesV[i][j].isBorder = true;
+				continue;
+			}
+			if (checkClosure && abs(pathLinesV[i][j].startPoint.x - pathLinesV[i][j].endPoint.x) <= 0.5 && abs(pathLinesV[i][j].startPoint.y - pathLinesV[i][j].endPoint.y) <= 0.5)
+			{
+				//近似首尾相连
+				pathLinesV[i][j].isCircle = true;
+				pathLinesV[i][j].endPoint = pathLinesV[i][j].startPoint;
+			}
+		}
+	}
+}
+
+/**  串行及OpenMP版本的临时内存：多帧连续计算时由调用者保留，各帧重复使用，不再每帧重新分配 **/
+struct ContourWorkspace
+{
+	vector<isotools::Edge> edgeArray;//格点上生成的等值线片段
+	vector< vector<isotools::Isoline>> pathLinesV1, pathLinesV2, pathLinesV3, pathLinesTemp;//后三个section的拼接结果及合并用的临时结果
+	vector<vector<int>> pathLinesHit, pathLinesHit1, pathLinesHit2, pathLinesHit3;//四个section的命中表（串行版本只用第一个）
+	vector<CrossingCache> crossingCaches[4];//每个section每个等值一个交点缓存
+	vector<float> cellMin, cellMax;//cell四个格点的最小值和最大值
+	vector< list<isotools::Point2D> > freeNodes;//每个（section × 等值）拼接任务回收的点结点，生成等值线时优先复用，不再逐点分配；串行版本只用第一个
+	vector< size_t > nodeDemand;//上一帧每个拼接任务用到的点结点数量，按此把回收的结点分给各任务
+	CoordinateTable table;//格点坐标查找表
+
+	ContourWorkspace() : freeNodes(1) {}
+};
+
+/************************************************************************/
+/* Funciton: resetLevels
+ * Description: 把按等值分组的数组调整为levelNum组并清空每组，保留已分配的内存
+ * Input:
+	levels: 按等值分组的数组
+	levelNum: 等值的数量
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template <typename T>
+static void resetLevels(vector< vector<T> > &levels, int levelNum)
+{
+	levels.resize(levelNum);
+	for (int m = 0; m < levelNum; ++m)
+	{
+		levels[m].clear();
+	}
+}
+
+/************************************************************************/
+/* Funciton: recycleLevels
+ * Description: 把按等值分组的等值线上的点结点全部移到freeNodes，之后清空这些等值线时不再逐个释放结点
+ * Input:
+	levels: 按等值分组的等值线集合，调用后各条等值线的点链为空
+	freeNodes: 回收的空闲结点
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void recycleLevels(vector< vector<isotools::Isoline> > &levels, list<isotools::Point2D> &freeNodes)
+{
+	int levelNum = levels.size();
+	for (int m = 0; m < levelNum; ++m)
+	{
+		int lineNum = levels[m].size();
+		for (int k = 0; k < lineNum; ++k)
+		{
+			freeNodes.splice(freeNodes.end(), levels[m][k].points);
+		}
+	}
+}
+
+/************************************************************************/
+/* Funciton: doMarchingSquaresAccelerate 【普通CPU串行算法】
+ * Description: Marching Squares 算法的实现
+ * Input:
+	data: 天气数据值二维数组
+	isovalues: 等值线值数组
+	pathLinesV: 返回该等值数组下的所有各条等值线数组的集合
+	startLongitude: 起始经度（起始x坐标）
+	longitudeGridSpace: 经度间隔（x坐标间隔）
+	startLatitude: 起始纬度（起始y坐标）
+	latitudeGridSpace: 纬度间隔（y坐标间隔）
+	maxGridValue: 网格点中的最大值
+	minGridValue: 网格点中的最小值
+	options: 缺测值、格点坐标等可选设置，为NULL时不判断缺测并使用规则网格
+	workspace: 可选的临时内存，多帧连续计算时传入同一个以复用内存和点结点，为NULL时使用局部变量
+* Output: void
+* Author: gcdofree
+* Date: 2014.11.3
+/************************************************************************/
+static void doMarchingSquaresAccelerate(vector<vector<float> > &data, vector<float> &isovalues, vector< vector<isotools::Isoline>> &pathLinesV,
+	float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace, float maxGridValue, float minGridValue,
+	const ContourOptions *options = NULL, ContourWorkspace *workspace = NULL)
+{
+	ContourWorkspace localWorkspace;
+	ContourWorkspace &ws = workspace != NULL ? *workspace : localWorkspace;
+	//上一次结果中的点结点先回收，新生成的等值线复用这些结点
+	recycleLevels(pathLinesV, ws.freeNodes[0]);
+
+	vector<vector<int>> &pathLinesHit = ws.pathLinesHit;
+
+	for (int m = 0; m < isovalues.size(); ++m)
+	{
+		if (isovalues[m] < minGridValue || isovalues[m] > maxGridValue)
+		{
+			isovalues.erase(isovalues.begin() + m);//对vector进行增删元素后，begin，end，size会失效，必须即时调用
+			m--;
+		}
+	}
+	int isovaluesNum = isovalues.size();
+	resetLevels(pathLinesV, isovaluesNum);
+	resetLevels(pathLinesHit, isovaluesNum);
+	if (data.size() < 2 || data[0].size() < 2)
+	{
+		return;
+	}
+
+	int dataSize_i = data.size() - 1;
+	CoordinateTable &table = ws.table;
+	buildCoordinateTable(data.size(), data[0].size(), startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace, options, table);
+	vector<CrossingCache> &crossingCaches = ws.crossingCaches[0];//每个等值一个交点缓存，共用的边只插值一次
+	crossingCaches.resize(isovaluesNum);
+	for (int m = 0; m < isovaluesNum; ++m)
+	{
+		crossingCaches[m].init(data[0].size());
+	}
+	vector<float> &cellMin = ws.cellMin, &cellMax = ws.cellMax;
+	list<isotools::Point2D> *freeNodes = &ws.freeNodes[0];
+	for (int i = 0; i<dataSize_i; ++i)//逐行扫
+	{
+		int dataSize_j = data[i].size() - 1;
+		//预先算好邻域四个格点的最大最小值，避免重复计算squareIndexs[m]；有缺测角点的cell在这里被排除
+		cellMin.resize(dataSize_j);
+		cellMax.resize(dataSize_j);
+		calcRowRange(data, i, options, cellMin.data(), cellMax.data());
+		for (int j = 0; j<dataSize_j; ++j)//逐列扫
+		{
+			float maxValue = cellMax[j], minValue = cellMin[j];
+
+			for (int m = 0; m<isovaluesNum; ++m)
 			{
 				if (isovalues[m] < minValue || isovalues[m] > maxValue)
 				{
 					continue;
 				}
 
-				int squareIndex = 0;
-				if (data[i][j] >= isovalues[m]) squareIndex |= 8;
-				if (data[i][j + 1] >= isovalues[m]) squareIndex |= 4;
-				if (data[i + 1][j + 1] >= isovalues[m]) squareIndex |= 2;
-				if (data[i + 1][j] >= isovalues[m]) squareIndex |= 1;
+				int squareIndex = getSquareIndex(data[i][j], data[i][j + 1], data[i + 1][j + 1], data[i + 1][j], isovalues[m]);
 
 				if (EdgeTable[squareIndex] != 0)
 				{
-					//消除二义性
-					if (squareIndex == 5)// index = 0x5 
-					{
-						float centerValue = (1 / 4.0) *(data[i][j] + data[i][j + 1] + data[i + 1][j + 1] + data[i + 1][j]);
-						if (centerValue < isovalues[m])
-						{
-							squareIndex = 10;
-						}
-					}
-					else if (squareIndex == 10)//0x10
-					{
-						float centerValue = (1 / 4.0) *(data[i][j] + data[i][j + 1] + data[i + 1][j + 1] + data[i + 1][j]);
-						if (centerValue < isovalues[m])
-						{
-							squareIndex = 5;
-						}
-					}
 					int edgeIndex1 = 0, edgeIndex2 = 0;
 					//将生成的该线段添加到某一等值线上或自己建立某条等值线
 					for (int k = 0; SegmentTable[squareIndex][k] != -1; k = k + 2)
 					{
 						edgeIndex1 = SegmentTable[squareIndex][k];
 						edgeIndex2 = SegmentTable[squareIndex][k + 1];
-						addPointToLineAccelerate(edgeIndex1, edgeIndex2, i, j, data, pathLinesHit[m], isovalues[m], pathLinesV[m], startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
+						addPointToLineAccelerate(edgeIndex1, edgeIndex2, i, j, data, pathLinesHit[m], isovalues[m], pathLinesV[m], table, &crossingCaches[m], freeNodes);
 					}
 				}
 			}
 		}
 	}
 
-	int pathLinesV_i = pathLinesV.size();
-	for (int i = 0; i<pathLinesV_i; ++i)
+	finishIsolines(data, pathLinesV, options);
+}
+
+/************************************************************************/
+/* Funciton: doGridCalcOMP 【多核CPU并行加速算法】
+ * Description: Marching Squares 算法的实现，首先计算单个格点上短等值线
+ * Input:
+	data: 天气数据值二维数组
+	isovalues: 等值线值数组
+	i: 格点所在cell中左上角点的数组x值下标
+	j: 格点所在cell中左上角点的数组y值下标
+	isovaluesNum: 等值数量
+	dataSize_j: 纬度方向有多少个格点
+	edgeArray: 存放所有生成的等值线临时边
+	minValue: cell四个格点的最小值（由calcRowRange预先算好）
+	maxValue: cell四个格点的最大值（由calcRowRange预先算好）
+ * Output: void
+ * Author: gcdofree
+ * Date: 2014.11.3
+/************************************************************************/
+static void doGridCalcOMP(vector<vector<float> > &data, vector<float> &isovalues, int i, int j, int isovaluesNum, int dataSize_j, isotools::Edge * &edgeArray,
+	float minValue, float maxValue)
+{
+	for (int m = 0; m < isovaluesNum; ++m)
 	{
-		int pathLinesV_j = pathLinesV[i].size();
-		for (int j = 0; j<pathLinesV_j; ++j)
+		if (isovalues[m] < minValue || isovalues[m] > maxValue)
 		{
-			if (abs(pathLinesV[i][j].startPoint.x - pathLinesV[i][j].endPoint.x) <= 0.5 && abs(pathLinesV[i][j].startPoint.y - pathLinesV[i][j].endPoint.y) <= 0.5)
-			{
-				//近似首尾相连
-				pathLinesV[i][j].isCircle = true;
-				pathLinesV[i][j].endPoint = pathLinesV[i][j].startPoint;
+			continue;
+		}
 
+		int squareIndex = getSquareIndex(data[i][j], data[i][j + 1], data[i + 1][j + 1], data[i + 1][j], isovalues[m]);
+
+		if (EdgeTable[squareIndex] != 0)
+		{
+			//将生成的该线段添加到某一等值线上或自己建立某条等值线
+			for (int k = 0; SegmentTable[squareIndex][k] != -1; k = k + 2)
+			{
+				int currentIndex = ((i*dataSize_j + j) * isovaluesNum + m) * 2 + k / 2;
+				//isotools::Edge tempEdge;
+				edgeArray[currentIndex].edgeIndex1 = SegmentTable[squareIndex][k];
+				edgeArray[currentIndex].edgeIndex2 = SegmentTable[squareIndex][k + 1];
+				edgeArray[currentIndex].i = i;
+				edgeArray[currentIndex].j = j;
+				edgeArray[currentIndex].m = m;//第m个等值线
+				edgeArray[currentIndex].isovalue = isovalues[m];//等值线的值
 			}
 		}
 	}
@@ -752,7 +1427,7 @@ static void doMarchingSquaresAccelerate(vector<vector<float> > &data, vector<flo
 
 /************************************************************************/
 /* Funciton: doGridCalcOMP 【多核CPU并行加速算法】
- * Description: Marching Squares 算法的实现，首先计算单个格点上短等值线
+ * Description: 计算单个格点上短等值线，cell的最大最小值在此处计算
  * Input:
 	data: 天气数据值二维数组
 	isovalues: 等值线值数组
@@ -768,61 +1443,176 @@ static void doMarchingSquaresAccelerate(vector<vector<float> > &data, vector<flo
 static void doGridCalcOMP(vector<vector<float> > &data, vector<float> &isovalues, int i, int j, int isovaluesNum, int dataSize_j, isotools::Edge * &edgeArray)
 {
 	//预先算好邻域四个格点的最大最小值，避免重复计算squareIndex
-	float maxValue = 0, minValue = FLT_MAX;
-	if (data[i][j] > maxValue) maxValue = data[i][j];
+	float maxValue = data[i][j], minValue = data[i][j];
 	if (data[i][j + 1] > maxValue) maxValue = data[i][j + 1];
 	if (data[i + 1][j + 1] > maxValue) maxValue = data[i + 1][j + 1];
 	if (data[i + 1][j] > maxValue) maxValue = data[i + 1][j];
-	if (data[i][j] < minValue) minValue = data[i][j];
 	if (data[i][j + 1] < minValue) minValue = data[i][j + 1];
 	if (data[i + 1][j + 1] < minValue) minValue = data[i + 1][j + 1];
 	if (data[i + 1][j] < minValue) minValue = data[i + 1][j];
+	doGridCalcOMP(data, isovalues, i, j, isovaluesNum, dataSize_j, edgeArray, minValue, maxValue);
+}
 
-	for (int m = 0; m < isovaluesNum; ++m)
+/************************************************************************/
+/* Funciton: doGridCalcTask 【任务并行版本使用】
+ * Description: 计算单个cell上的短等值线，与doGridCalcOMP相同，但格点在比较域中与事先换算好的阈值比较，
+ *	压缩存储的数据不需要还原；只有鞍点（0x5、0xa）按中心值判断时才用还原后的值，与getSquareIndex的结果完全一致。
+ *	等值数量和鞍点规则是模板参数：LevelNum大于0时循环次数和临时边下标中的等值数量在编译期确定，循环可以完全展开；
+ *	LevelNum为0时按isovaluesNum循环。鞍点规则不是按中心值判断时不需要还原格点值
+ * Input:
+	LevelNum: 编译期确定的等值数量，0表示运行时确定
+	Rule: 鞍点处的连接方式（SaddleRule）
+	data: 天气数据（vector< vector<float> >或GridView）
+	isovalues: 等值线值数组
+	thresholds: 每个等值在比较域中的阈值（由quantizeIsovalue换算）
+	i: 格点所在cell中左上角点的数组x值下标
+	j: 格点所在cell中左上角点的数组y值下标
+	isovaluesNum: 等值数量
+	dataSize_j: 纬度方向有多少个格点
+	edgeArray: 存放所有生成的等值线临时边
+	minKey: cell四个格点比较值的最小值（由calcRowRange预先算好）
+	maxKey: cell四个格点比较值的最大值（由calcRowRange预先算好）
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<int LevelNum, int Rule, class Grid>
+static inline void doGridCalcTask(const Grid &data, const vector<float> &isovalues, const vector<float> &thresholds, int i, int j, int isovaluesNum, int dataSize_j,
+	isotools::Edge *edgeArray, float minKey, float maxKey)
+{
+	const int levelNum = LevelNum > 0 ? LevelNum : isovaluesNum;
+	const auto *row0 = getGridRow(data, i);
+	const auto *row1 = getGridRow(data, i + 1);
+	float k8 = getGridKey(data, row0[j]), k4 = getGridKey(data, row0[j + 1]), k2 = getGridKey(data, row1[j + 1]), k1 = getGridKey(data, row1[j]);
+	isotools::Edge *cellEdges = &edgeArray[(i * dataSize_j + j) * levelNum * 2];
+	for (int m = 0; m < levelNum; ++m)
 	{
-		if (isovalues[m] < minValue || isovalues[m] > maxValue)
+		float threshold = thresholds[m];
+		if (threshold < minKey || threshold > maxKey)
 		{
 			continue;
 		}
 
-		int squareIndex = 0;
-		if (data[i][j] >= isovalues[m]) squareIndex |= 8;
-		if (data[i][j + 1] >= isovalues[m]) squareIndex |= 4;
-		if (data[i + 1][j + 1] >= isovalues[m]) squareIndex |= 2;
-		if (data[i + 1][j] >= isovalues[m]) squareIndex |= 1;
-
-		if (EdgeTable[squareIndex] != 0)
+		int squareIndex = (k8 >= threshold ? 8 : 0) | (k4 >= threshold ? 4 : 0) | (k2 >= threshold ? 2 : 0) | (k1 >= threshold ? 1 : 0);
+		if (Rule != SADDLE_JOIN_HIGH && (squareIndex == 5 || squareIndex == 10))
 		{
-			//消除二义性
-			if (squareIndex == 5)// index = 0x5 
+			if (Rule == SADDLE_JOIN_LOW)
 			{
-				float centerValue = (1 / 4.0) *(data[i][j] + data[i][j + 1] + data[i + 1][j + 1] + data[i + 1][j]);
-				if (centerValue < isovalues[m])
-				{
-					squareIndex = 10;
-				}
+				squareIndex = 15 - squareIndex;
 			}
-			else if (squareIndex == 10)//0x10
+			else
 			{
-				float centerValue = (1 / 4.0) *(data[i][j] + data[i][j + 1] + data[i + 1][j + 1] + data[i + 1][j]);
+				float centerValue = (1 / 4.0) * (dequantize(data, row0[j]) + dequantize(data, row0[j + 1]) + dequantize(data, row1[j + 1]) + dequantize(data, row1[j]));
 				if (centerValue < isovalues[m])
 				{
-					squareIndex = 5;
+					squareIndex = 15 - squareIndex;
 				}
 			}
-			//将生成的该线段添加到某一等值线上或自己建立某条等值线
-			for (int k = 0; SegmentTable[squareIndex][k] != -1; k = k + 2)
-			{
-				int currentIndex = ((i*dataSize_j + j) * isovaluesNum + m) * 2 + k / 2;
-				//isotools::Edge tempEdge;
-				edgeArray[currentIndex].edgeIndex1 = SegmentTable[squareIndex][k];
-				edgeArray[currentIndex].edgeIndex2 = SegmentTable[squareIndex][k + 1];
-				edgeArray[currentIndex].i = i;
-				edgeArray[currentIndex].j = j;
-				edgeArray[currentIndex].m = m;//第m个等值线
-				edgeArray[currentIndex].isovalue = isovalues[m];//等值线的值
-			}
 		}
+
+		const int *segment = SegmentTable[squareIndex];
+		for (int k = 0; segment[k] != -1; k = k + 2)
+		{
+			isotools::Edge &edge = cellEdges[m * 2 + k / 2];
+			edge.edgeIndex1 = segment[k];
+			edge.edgeIndex2 = segment[k + 1];
+			edge.i = i;
+			edge.j = j;
+			edge.m = m;
+			edge.isovalue = isovalues[m];
+		}
+	}
+}
+
+/************************************************************************/
+/* Funciton: doRowCalcTask 【任务并行版本使用】
+ * Description: 计算一行中[colBegin, colEnd)的cell上的短等值线。LevelNum大于0时先求出所有阈值的范围，
+ *	范围外的cell整个跳过（临时边已初始化为-1），其余cell所有等值一次算完
+ * Input:
+	LevelNum、Rule、data、isovalues、thresholds、isovaluesNum、dataSize_j、edgeArray: 同doGridCalcTask
+	i: cell所在行
+	colBegin: 起始cell列
+	colEnd: 结束cell列（不含）
+	cellMin: 每个cell四个格点比较值的最小值
+	cellMax: 每个cell四个格点比较值的最大值
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<int LevelNum, int Rule, class Grid>
+static void doRowCalcTask(const Grid &data, const vector<float> &isovalues, const vector<float> &thresholds, int i, int colBegin, int colEnd,
+	int isovaluesNum, int dataSize_j, isotools::Edge *edgeArray, const float *cellMin, const float *cellMax)
+{
+	if (LevelNum == 0)
+	{
+		for (int j = colBegin; j < colEnd; ++j)
+		{
+			doGridCalcTask<0, Rule>(data, isovalues, thresholds, i, j, isovaluesNum, dataSize_j, edgeArray, cellMin[j], cellMax[j]);
+		}
+		return;
+	}
+	float minThreshold = thresholds[0], maxThreshold = thresholds[0];
+	for (int m = 1; m < LevelNum; ++m)
+	{
+		minThreshold = thresholds[m] < minThreshold ? thresholds[m] : minThreshold;
+		maxThreshold = thresholds[m] > maxThreshold ? thresholds[m] : maxThreshold;
+	}
+	for (int j = colBegin; j < colEnd; ++j)
+	{
+		if (cellMax[j] < minThreshold || cellMin[j] > maxThreshold)
+		{
+			continue;
+		}
+		doGridCalcTask<LevelNum, Rule>(data, isovalues, thresholds, i, j, LevelNum, dataSize_j, edgeArray, cellMin[j], cellMax[j]);
+	}
+}
+
+/**  按行计算短等值线的函数类型 **/
+template<class Grid>
+struct RowCalcTask
+{
+	typedef void (*Func)(const Grid &, const vector<float> &, const vector<float> &, int, int, int, int, int, isotools::Edge *, const float *, const float *);
+};
+
+/************************************************************************/
+/* Funciton: selectRowCalcTask
+ * Description: 按等值数量和鞍点规则选择编译期特化的doRowCalcTask；常用的等值数量（1～6、8、10、12、16、20）
+ *	有各自展开的版本，其他数量使用运行时循环的通用版本
+ * Input:
+	levelNum: 等值数量
+	saddleRule: 鞍点处的连接方式（SaddleRule）
+ * Output: 函数指针，每行调用一次
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<int Rule, class Grid>
+static typename RowCalcTask<Grid>::Func selectRowCalcTask(int levelNum)
+{
+	switch (levelNum)
+	{
+	case 1: return &doRowCalcTask<1, Rule, Grid>;
+	case 2: return &doRowCalcTask<2, Rule, Grid>;
+	case 3: return &doRowCalcTask<3, Rule, Grid>;
+	case 4: return &doRowCalcTask<4, Rule, Grid>;
+	case 5: return &doRowCalcTask<5, Rule, Grid>;
+	case 6: return &doRowCalcTask<6, Rule, Grid>;
+	case 8: return &doRowCalcTask<8, Rule, Grid>;
+	case 10: return &doRowCalcTask<10, Rule, Grid>;
+	case 12: return &doRowCalcTask<12, Rule, Grid>;
+	case 16: return &doRowCalcTask<16, Rule, Grid>;
+	case 20: return &doRowCalcTask<20, Rule, Grid>;
+	default: return &doRowCalcTask<0, Rule, Grid>;
+	}
+}
+
+template<class Grid>
+static typename RowCalcTask<Grid>::Func selectRowCalcTask(int levelNum, int saddleRule)
+{
+	switch (saddleRule)
+	{
+	case SADDLE_JOIN_HIGH: return selectRowCalcTask<SADDLE_JOIN_HIGH, Grid>(levelNum);
+	case SADDLE_JOIN_LOW: return selectRowCalcTask<SADDLE_JOIN_LOW, Grid>(levelNum);
+	default: return selectRowCalcTask<SADDLE_CENTER, Grid>(levelNum);
 	}
 }
 
@@ -830,303 +1620,1444 @@ static void doGridCalcOMP(vector<vector<float> > &data, vector<float> &isovalues
 /* Funciton: isMergeTwoIsoLine
  * Description: 进行线段合并操作
  * Input:
-	i: 第i个等值
 	j1: 表示第一条等值线的位置
 	j2: 表示第二条等值线的位置
 	size1: 表示第一条等值线上点的数量
 	size2: 表示第二条等值线上点的数量
-	pathLines: 等值线集合
+	pathLines: 同一等值的等值线集合
  * Output: 若有线段合并，则返回true，否则返回false
  * Author: gcdofree
  * Date: 2014.11.3
 /************************************************************************/
-static bool isMergeTwoIsoLine(int i, int j1, int j2, int size1, int size2, vector< vector<isotools::Isoline> > &pathLines)
+static bool isMergeTwoIsoLine(int j1, int j2, int size1, int size2, vector<isotools::Isoline> &pathLines)
 {
 	if (size1 == 0 || size2 == 0)
 	{
 		return false;
 	}
 
-	if (pathLines[i][j1].isCircle || pathLines[i][j2].isCircle)
+	if (pathLines[j1].isCircle || pathLines[j2].isCircle)
 	{
 		return false;
 	}
 
-	if (pathLines[i][j1].startPoint == pathLines[i][j2].startPoint && pathLines[i][j1].endPoint == pathLines[i][j2].endPoint)//头头，尾尾
+	if (pathLines[j1].startPoint == pathLines[j2].startPoint && pathLines[j1].endPoint == pathLines[j2].endPoint)//头头，尾尾
 	{
 		if (size1 < size2)//把j1的点添加到j2
 		{
-			pathLines[i][j2].isCircle = true;
-			pathLines[i][j2].endPoint = pathLines[i][j2].startPoint;
-			for (int kk = 0; kk < size1; ++kk)
-			{
-				pathLines[i][j2].points.push_back(pathLines[i][j1].points.back());
-				pathLines[i][j1].points.pop_back();
-			}
-			pathLines[i].erase(pathLines[i].begin() + j1);
+			pathLines[j2].isCircle = true;
+			pathLines[j2].endPoint = pathLines[j2].startPoint;
+			isotools::joinIsolineMetrics(pathLines[j2], pathLines[j1], false, true);
+			moveIsolinePoints(pathLines[j2].points, false, pathLines[j1].points, true);
+			pathLines.erase(pathLines.begin() + j1);
 		}
 		else//把j2的点添加到j1
 		{
-			pathLines[i][j1].isCircle = true;
-			pathLines[i][j1].endPoint = pathLines[i][j1].startPoint;
-			for (int kk = 0; kk < size2; ++kk)
-			{
-				pathLines[i][j1].points.push_back(pathLines[i][j2].points.back());
-				pathLines[i][j2].points.pop_back();
-			}
-			pathLines[i].erase(pathLines[i].begin() + j2);
+			pathLines[j1].isCircle = true;
+			pathLines[j1].endPoint = pathLines[j1].startPoint;
+			isotools::joinIsolineMetrics(pathLines[j1], pathLines[j2], false, true);
+			moveIsolinePoints(pathLines[j1].points, false, pathLines[j2].points, true);
+			pathLines.erase(pathLines.begin() + j2);
+		}
+		return true;
+	}
+	else if (pathLines[j1].startPoint == pathLines[j2].endPoint && pathLines[j1].endPoint == pathLines[j2].startPoint)//头尾，尾头
+	{
+		if (size1 < size2)//把j1的点添加到j2
+		{
+			pathLines[j2].isCircle = true;
+			pathLines[j2].endPoint = pathLines[j2].startPoint;
+			isotools::joinIsolineMetrics(pathLines[j2], pathLines[j1], false, false);
+			moveIsolinePoints(pathLines[j2].points, false, pathLines[j1].points, false);
+			pathLines.erase(pathLines.begin() + j1);
+		}
+		else//把j2的点添加到j1
+		{
+			pathLines[j1].isCircle = true;
+			pathLines[j1].endPoint = pathLines[j1].startPoint;
+			isotools::joinIsolineMetrics(pathLines[j1], pathLines[j2], false, false);
+			moveIsolinePoints(pathLines[j1].points, false, pathLines[j2].points, false);
+			pathLines.erase(pathLines.begin() + j2);
+		}
+		return true;
+	}
+	else if (pathLines[j1].startPoint == pathLines[j2].startPoint)//头头
+	{
+		if (size1 < size2)//把j1的点添加到j2
+		{
+			pathLines[j2].startPoint = pathLines[j1].endPoint;
+			isotools::joinIsolineMetrics(pathLines[j2], pathLines[j1], true, true);
+			moveIsolinePoints(pathLines[j2].points, true, pathLines[j1].points, true);
+			pathLines.erase(pathLines.begin() + j1);
+		}
+		else//把j2的点添加到j1
+		{
+			pathLines[j1].startPoint = pathLines[j2].endPoint;
+			isotools::joinIsolineMetrics(pathLines[j1], pathLines[j2], true, true);
+			moveIsolinePoints(pathLines[j1].points, true, pathLines[j2].points, true);
+			pathLines.erase(pathLines.begin() + j2);
+		}
+		return true;
+	}
+	else if (pathLines[j1].startPoint == pathLines[j2].endPoint)//头尾
+	{
+		if (size1 < size2)//把j1的点添加到j2
+		{
+			pathLines[j2].endPoint = pathLines[j1].endPoint;
+			isotools::joinIsolineMetrics(pathLines[j2], pathLines[j1], false, false);
+			moveIsolinePoints(pathLines[j2].points, false, pathLines[j1].points, false);
+			pathLines.erase(pathLines.begin() + j1);
+		}
+		else//把j2的点添加到j1
+		{
+			pathLines[j1].startPoint = pathLines[j1].startPoint;
+			isotools::joinIsolineMetrics(pathLines[j1], pathLines[j2], true, false);
+			moveIsolinePoints(pathLines[j1].points, true, pathLines[j2].points, false);
+			pathLines.erase(pathLines.begin() + j2);
+		}
+		return true;
+	}
+	else if (pathLines[j1].endPoint == pathLines[j2].endPoint)//尾尾
+	{
+		if (size1 < size2)//把j1的点添加到j2
+		{
+			pathLines[j2].endPoint = pathLines[j1].startPoint;
+			isotools::joinIsolineMetrics(pathLines[j2], pathLines[j1], false, true);
+			moveIsolinePoints(pathLines[j2].points, false, pathLines[j1].points, true);
+			pathLines.erase(pathLines.begin() + j1);
+		}
+		else//把j2的点添加到j1
+		{
+			pathLines[j1].endPoint = pathLines[j2].startPoint;
+			isotools::joinIsolineMetrics(pathLines[j1], pathLines[j2], false, true);
+			moveIsolinePoints(pathLines[j1].points, false, pathLines[j2].points, true);
+			pathLines.erase(pathLines.begin() + j2);
 		}
 		return true;
 	}
-	else if (pathLines[i][j1].startPoint == pathLines[i][j2].endPoint && pathLines[i][j1].endPoint == pathLines[i][j2].startPoint)//头尾，尾头
+	else if (pathLines[j1].endPoint == pathLines[j2].startPoint)//尾头
 	{
 		if (size1 < size2)//把j1的点添加到j2
 		{
-			pathLines[i][j2].isCircle = true;
-			pathLines[i][j2].endPoint = pathLines[i][j2].startPoint;
-			for (int kk = 0; kk < size1; ++kk)
+			pathLines[j2].startPoint = pathLines[j1].startPoint;
+			isotools::joinIsolineMetrics(pathLines[j2], pathLines[j1], true, false);
+			moveIsolinePoints(pathLines[j2].points, true, pathLines[j1].points, false);
+			pathLines.erase(pathLines.begin() + j1);
+		}
+		else//把j2的点添加到j1
+		{
+			pathLines[j1].endPoint = pathLines[j2].endPoint;
+			isotools::joinIsolineMetrics(pathLines[j1], pathLines[j2], false, false);
+			moveIsolinePoints(pathLines[j1].points, false, pathLines[j2].points, false);
+			pathLines.erase(pathLines.begin() + j2);
+		}
+		return true;
+	}
+	return false;
+}
+
+/************************************************************************/
+/* Funciton: isMergeTwoIsoLine
+ * Description: 进行线段合并操作（按等值下标访问的版本）
+ * Input:
+	i: 第i个等值
+	j1: 表示第一条等值线的位置
+	j2: 表示第二条等值线的位置
+	size1: 表示第一条等值线上点的数量
+	size2: 表示第二条等值线上点的数量
+	pathLines: 等值线集合
+ * Output: 若有线段合并，则返回true，否则返回false
+ * Author: gcdofree
+ * Date: 2014.11.3
+/************************************************************************/
+static bool isMergeTwoIsoLine(int i, int j1, int j2, int size1, int size2, vector< vector<isotools::Isoline> > &pathLines)
+{
+	return isMergeTwoIsoLine(j1, j2, size1, size2, pathLines[i]);
+}
+
+/************************************************************************/
+/* Funciton: isMergeTwoAreaLevel
+ * Description: 对单个等值进行区域合并，不同等值之间互不相关，可以并行执行
+ * Input:
+	mergePos: 表示两个区域相邻的边界区域
+	pathLines: 第一个区域中该等值的等值线集合
+	pathLines1: 第二个区域中该等值的等值线集合
+	pathLinesTemp: 临时存放等值线的集合
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void isMergeTwoAreaLevel(int mergePos, vector<isotools::Isoline> &pathLines,
+	vector<isotools::Isoline> &pathLines1, vector<isotools::Isoline> &pathLinesTemp)
+{
+	pathLinesTemp.clear();
+	//pathLines查找边界片段，并加入到pathLinesTemp中
+	int pathLinesSize1_j = pathLines.size();
+	for (int j = 0; j < pathLinesSize1_j; j++)
+	{
+		if ((pathLines[j].startPoint.x > mergePos - 1 && pathLines[j].startPoint.x <= mergePos) ||
+			pathLines[j].endPoint.x > mergePos - 1 && pathLines[j].endPoint.x <= mergePos)
+		{
+			if (!pathLines[j].isCircle)
 			{
-				pathLines[i][j2].points.push_back(pathLines[i][j1].points.front());
-				pathLines[i][j1].points.pop_front();
+				pathLines[j].isBorder = true;
+				pathLinesTemp.push_back(isotools::Isoline());//交换而不复制，点链结点不重新分配
+				swap(pathLinesTemp.back(), pathLines[j]);
+				pathLines.erase(pathLines.begin() + j);
+				--j;
+				--pathLinesSize1_j;
 			}
-			pathLines[i].erase(pathLines[i].begin() + j1);
 		}
-		else//把j2的点添加到j1
+	}
+	//pathLines1查找边界片段，并加入到pathLinesTemp中
+	int pathLinesSize2_j = pathLines1.size();
+	for (int j = 0; j < pathLinesSize2_j; j++)
+	{
+		if ((pathLines1[j].startPoint.x > mergePos - 1 && pathLines1[j].startPoint.x <= mergePos) ||
+			pathLines1[j].endPoint.x > mergePos - 1 && pathLines1[j].endPoint.x <= mergePos)
 		{
-			pathLines[i][j1].isCircle = true;
-			pathLines[i][j1].endPoint = pathLines[i][j1].startPoint;
-			for (int kk = 0; kk < size2; ++kk)
+			if (!pathLines1[j].isCircle)
 			{
-				pathLines[i][j1].points.push_back(pathLines[i][j2].points.front());
-				pathLines[i][j2].points.pop_front();
+				pathLines1[j].isBorder = true;
+				pathLinesTemp.push_back(isotools::Isoline());
+				swap(pathLinesTemp.back(), pathLines1[j]);
+				pathLines1.erase(pathLines1.begin() + j);
+				--j;
+				--pathLinesSize2_j;
 			}
-			pathLines[i].erase(pathLines[i].begin() + j2);
 		}
-		return true;
 	}
-	else if (pathLines[i][j1].startPoint == pathLines[i][j2].startPoint)//头头
+
+	//对pathLinesTemp中的片段进行拼接
+	int pathLinesSizej = pathLinesTemp.size();
+	for (int j = 0; j < pathLinesSizej - 1; ++j)
 	{
-		if (size1 < size2)//把j1的点添加到j2
+		for (int k = j + 1; k < pathLinesSizej; ++k)
 		{
-			pathLines[i][j2].startPoint = pathLines[i][j1].endPoint;
-			for (int kk = 0; kk < size1; ++kk)
+			bool isMerge = isMergeTwoIsoLine(j, k, pathLinesTemp[j].points.size(), pathLinesTemp[k].points.size(), pathLinesTemp);
+			if (isMerge)
 			{
-				pathLines[i][j2].points.push_front(pathLines[i][j1].points.front());
-				pathLines[i][j1].points.pop_front();
+				--j;
+				--pathLinesSizej;
+				break;
 			}
-			pathLines[i].erase(pathLines[i].begin() + j1);
 		}
-		else//把j2的点添加到j1
+	}
+	//将拼接结果加入到pathLines
+	for (int j = 0; j < pathLinesSizej; ++j)
+	{
+		pathLines.push_back(isotools::Isoline());
+		swap(pathLines.back(), pathLinesTemp[j]);
+	}
+	//将pathLines1中的等值线加入到pathLines
+	pathLinesSizej = pathLines1.size();
+	for (int j = 0; j < pathLinesSizej; ++j)
+	{
+		pathLines.push_back(isotools::Isoline());
+		swap(pathLines.back(), pathLines1[j]);
+	}
+}
+
+/************************************************************************/
+/* Funciton: isMergeTwoArea
+ * Description: 进行区域合并
+ * Input:
+	mergePos: 表示两个区域相邻的边界区域
+	pathLinesV: 第一个区域的等值线集合
+	pathLinesV1: 第二个区域的等值线集合
+	pathLinesTemp: 临时存放等值线的集合
+ * Output: void
+ * Author: gcdofree
+ * Date: 2014.11.3
+/************************************************************************/
+static void isMergeTwoArea(int mergePos, vector< vector<isotools::Isoline>> &pathLinesV,
+	vector< vector<isotools::Isoline>> &pathLinesV1, vector< vector<isotools::Isoline>> &pathLinesTemp)
+{
+	//对局部拼接结果进行合并
+	//pathLinesV + pathLinesV1
+	int pathLinesSize1_i = pathLinesV.size();
+	resetLevels(pathLinesTemp, pathLinesSize1_i);
+	for (int i = 0; i < pathLinesSize1_i; ++i)
+	{
+		isMergeTwoAreaLevel(mergePos, pathLinesV[i], pathLinesV1[i], pathLinesTemp[i]);
+	}
+}
+
+/************************************************************************/
+/* Funciton: doMarchingSquaresAccelerateOMP 【此方法适用于 多核CPU】
+ * Description: Marching Squares 算法的实现，首先计算生成所有的格点上短等值线，之后再进行合并拼接
+ * Input:
+	data: 天气数据值二维数组
+	isovalues: 等值线值数组
+	pathLinesV: 返回该等值数组下的所有各条等值线数组的集合
+	startLongitude: 起始经度（起始x坐标）
+	longitudeGridSpace: 经度间隔（x坐标间隔）
+	startLatitude: 起始纬度（起始y坐标）
+	latitudeGridSpace: 纬度间隔（y坐标间隔）
+	maxGridValue: 网格点中的最大值
+	minGridValue: 网格点中的最小值
+	options: 缺测值、格点坐标等可选设置，为NULL时不判断缺测并使用规则网格
+	workspace: 可选的临时内存，多帧连续计算时传入同一个以复用内存和点结点，为NULL时使用局部变量
+* Output: void
+* Author: gcdofree
+* Date: 2014.11.3
+/************************************************************************/
+static void doMarchingSquaresAccelerateOMP(vector<vector<float> > &data, vector<float> &isovalues, vector< vector<isotools::Isoline>> &pathLinesV,
+	float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace, float maxGridValue, float minGridValue,
+	const ContourOptions *options = NULL, ContourWorkspace *workspace = NULL)
+{
+	//利用OpenMP加速。拼接阶段分为四个section，每个（section × 等值）是一个独立的任务
+	ContourWorkspace localWorkspace;
+	ContourWorkspace &ws = workspace != NULL ? *workspace : localWorkspace;
+	vector< vector<isotools::Isoline>> &pathLinesV1 = ws.pathLinesV1, &pathLinesV2 = ws.pathLinesV2,
+		&pathLinesV3 = ws.pathLinesV3, &pathLinesTemp = ws.pathLinesTemp;
+	//上一帧的结果及各临时结果中的点结点先回收，之后按各section上一帧的用量分配
+	recycleLevels(pathLinesV, ws.freeNodes[0]);
+	recycleLevels(pathLinesV1, ws.freeNodes[0]);
+	recycleLevels(pathLinesV2, ws.freeNodes[0]);
+	recycleLevels(pathLinesV3, ws.freeNodes[0]);
+	recycleLevels(pathLinesTemp, ws.freeNodes[0]);
+
+	isotools::Edge *edgeArray;//用于存放生成的等值线片段
+	vector<vector<int>> &pathLinesHit = ws.pathLinesHit, &pathLinesHit1 = ws.pathLinesHit1,
+		&pathLinesHit2 = ws.pathLinesHit2, &pathLinesHit3 = ws.pathLinesHit3;
+
+	int isovaluesNum = isovalues.size();
+	for (int m = 0; m < isovaluesNum; ++m)
+	{
+		if (isovalues[m] < minGridValue || isovalues[m] > maxGridValue)
+		{
+			isovalues.erase(isovalues.begin() + m);//对vector进行增删元素后，begin，end，size会失效，必须即时调用
+			m--;
+			isovaluesNum--;
+		}
+	}
+	
+	resetLevels(pathLinesV, isovaluesNum);
+	resetLevels(pathLinesV1, isovaluesNum);
+	resetLevels(pathLinesV2, isovaluesNum);
+	resetLevels(pathLinesV3, isovaluesNum);
+	resetLevels(pathLinesTemp, isovaluesNum);
+	resetLevels(pathLinesHit, isovaluesNum);
+	resetLevels(pathLinesHit1, isovaluesNum);
+	resetLevels(pathLinesHit2, isovaluesNum);
+	resetLevels(pathLinesHit3, isovaluesNum);
+	if (data.size() < 2 || data[0].size() < 2)
+	{
+		return;
+	}
+
+	//首先生成所有格点上短的等值线
+
+	int dataSize_i = data.size() - 1;
+	int dataSize_j = data[0].size() - 1;
+
+	int edgeSize = dataSize_i*dataSize_j*isovaluesNum * 2;
+
+	ws.edgeArray.resize(edgeSize);
+	edgeArray = ws.edgeArray.data();
+	CoordinateTable &table = ws.table;
+	buildCoordinateTable(data.size(), data[0].size(), startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace, options, table);
+	vector<CrossingCache> *crossingCaches = ws.crossingCaches;//每个section每个等值一个交点缓存
+	for (int s = 0; s < 4; ++s)
+	{
+		crossingCaches[s].resize(isovaluesNum);
+		for (int m = 0; m < isovaluesNum; ++m)
+		{
+			crossingCaches[s][m].init(data[0].size());
+		}
+	}
+
+#pragma omp parallel for	
+	for (int i = 0; i < edgeSize; ++i)
+	{
+		edgeArray[i].m = -1;//初始化为-1，表示该位置没有生成边（不再使用999作为标记，避免与等值冲突）
+	}
+
+	ws.cellMin.resize((size_t)dataSize_i * dataSize_j);//每行单独一段，各线程互不影响
+	ws.cellMax.resize((size_t)dataSize_i * dataSize_j);
+#pragma omp parallel for	
+	for (int i = 0; i<dataSize_i; ++i)//逐行扫
+	{
+		float *cellMin = ws.cellMin.data() + (size_t)i * dataSize_j;
+		float *cellMax = ws.cellMax.data() + (size_t)i * dataSize_j;
+		calcRowRange(data, i, options, cellMin, cellMax);
+		for (int j = 0; j<dataSize_j; ++j)//逐列扫
+		{
+			doGridCalcOMP(data, isovalues, i, j, isovaluesNum, dataSize_j, edgeArray, cellMin[j], cellMax[j]);
+		}
+	}
+
+	//回收的结点按上一帧各拼接任务的用量分出去，剩下的都留给第一个任务；等值数量变化时上一帧的用量不再适用
+	int taskNum = 4 * isovaluesNum;
+	vector< list<isotools::Point2D> > &freeNodes = ws.freeNodes;
+	if ((int)freeNodes.size() < taskNum)
+	{
+		freeNodes.resize(taskNum);
+	}
+	for (int t = 1; t < (int)freeNodes.size(); ++t)
+	{
+		freeNodes[0].splice(freeNodes[0].end(), freeNodes[t]);
+	}
+	if ((int)ws.nodeDemand.size() != taskNum)
+	{
+		ws.nodeDemand.assign(taskNum, 0);
+	}
+	for (int t = 1; t < taskNum; ++t)
+	{
+		list<isotools::Point2D>::iterator last = freeNodes[0].begin();
+		advance(last, min(ws.nodeDemand[t], freeNodes[0].size()));
+		freeNodes[t].splice(freeNodes[t].end(), freeNodes[0], freeNodes[0].begin(), last);
+	}
+
+	//开始进行局部拼接，四个section的临时边范围不变；不同等值的等值线集合互不相关，
+	//每个（section × 等值）作为一个任务动态调度，稠密的等值不会拖慢稀疏的等值，并行度也不再受限于section的数量
+	int sectionEdge[5] = { 0, edgeSize / 4, edgeSize / 2, edgeSize / 4 * 3, edgeSize };
+	vector< vector<isotools::Isoline>> *sectionLines[4] = { &pathLinesV, &pathLinesV1, &pathLinesV2, &pathLinesV3 };
+	vector<vector<int>> *sectionHits[4] = { &pathLinesHit, &pathLinesHit1, &pathLinesHit2, &pathLinesHit3 };
+	int cellEdgeNum = isovaluesNum * 2;//每个cell的临时边数量，第m个等值的临时边位于cell内的m * 2和m * 2 + 1
+#pragma omp parallel for schedule(dynamic)
+	for (int t = 0; t < taskNum; ++t)
+	{
+		int s = t / isovaluesNum, m = t % isovaluesNum;
+		vector<isotools::Isoline> &lines = (*sectionLines[s])[m];
+		vector<int> &hits = (*sectionHits[s])[m];
+		//按临时边下标的顺序处理本等值的临时边，与逐个检查section内的所有临时边得到相同的结果
+		for (int cell = sectionEdge[s] / cellEdgeNum; cell * cellEdgeNum < sectionEdge[s + 1]; ++cell)
+		{
+			for (int k = 0; k < 2; ++k)
+			{
+				int i = cell * cellEdgeNum + m * 2 + k;
+				if (i >= sectionEdge[s] && i < sectionEdge[s + 1] && edgeArray[i].m >= 0)
+				{
+					addPointToLineAccelerate(edgeArray[i].edgeIndex1, edgeArray[i].edgeIndex2, edgeArray[i].i, edgeArray[i].j,
+						data, hits, edgeArray[i].isovalue, lines, table, &crossingCaches[s][m], &freeNodes[t]);
+				}
+			}
+		}
+	}
+
+	//记录各拼接任务用到的结点数量（线上的点加上还没用完的回收结点），下一帧按此分配
+	for (int t = 0; t < taskNum; ++t)
+	{
+		const vector<isotools::Isoline> &lines = (*sectionLines[t / isovaluesNum])[t % isovaluesNum];
+		size_t nodeNum = freeNodes[t].size();
+		int lineNum = lines.size();
+		for (int k = 0; k < lineNum; ++k)
+		{
+			nodeNum += lines[k].points.size();
+		}
+		ws.nodeDemand[t] = nodeNum;
+	}
+
+	//区域拼接
+	isMergeTwoArea(dataSize_i / 4, pathLinesV, pathLinesV1, pathLinesTemp);
+	isMergeTwoArea(dataSize_i / 4 * 3, pathLinesV2, pathLinesV3, pathLinesTemp);
+	isMergeTwoArea(dataSize_i / 2, pathLinesV, pathLinesV2, pathLinesTemp);
+
+	finishIsolines(data, pathLinesV, options);
+}
+
+/************************************************************************/
+/* Funciton: getBandStart
+ * Description: 按行划分并行拼接区域，区域数量不超过maxBandNum，每个区域至少包含TASK_BAND_MIN_ROWS行
+ * Input:
+	rowNum: cell的行数
+	maxBandNum: 区域数量的上限
+	bandStart: 返回每个区域的起始行，最后一个元素为rowNum
+ * Output: 区域数量
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int getBandStart(int rowNum, int maxBandNum, vector<int> &bandStart)
+{
+	int bandNum = rowNum / TASK_BAND_MIN_ROWS;
+	if (bandNum > maxBandNum)
+		bandNum = maxBandNum;
+	if (bandNum < 1)
+		bandNum = 1;
+	bandStart.resize(bandNum + 1);
+	for (int b = 0; b <= bandNum; ++b)
+	{
+		bandStart[b] = (int)((long long)rowNum * b / bandNum);
+	}
+	return bandNum;
+}
+
+/************************************************************************/
+/* Funciton: getTaskBandLimit
+ * Description: 获得拼接区域数量的上限：等值足够多时区域数量等于线程数，（区域 × 等值）任务已足够动态调度；
+ *	等值较少时增加区域数量，使每个线程约有TASK_STITCH_TASKS_PER_THREAD个任务，并行度不受线程数限制
+ * Input:
+	threadNum: 线程数
+	levelNum: 等值（或等值带）的数量
+ * Output: 区域数量的上限
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int getTaskBandLimit(int threadNum, int levelNum)
+{
+	int bandLimit = (threadNum * TASK_STITCH_TASKS_PER_THREAD + levelNum - 1) / max(levelNum, 1);
+	return max(bandLimit, threadNum);
+}
+
+/**  拼接阶段的一组等值线，只保存交点所在边的编号，坐标在拼接完成后统一计算；
+ *	所有等值线的边编号连续存放，清空时不释放内存 **/
+struct EdgeIdLines
+{
+	vector< unsigned long long > ids;//各条等值线依次经过的边编号，构成环时首尾不重复
+	vector< int > start;//每条等值线在ids中的起始位置，最后一个元素为ids的长度
+	vector< char > isCircle;//每条等值线是否构成环
+
+	EdgeIdLines() : start(1, 0) {}
+
+	int size() const
+	{
+		return isCircle.size();
+	}
+
+	void clear()
+	{
+		ids.clear();
+		start.assign(1, 0);
+		isCircle.clear();
+	}
+
+	/* ids末尾新加入的边编号作为一条等值线 */
+	void finishLine(bool circle)
+	{
+		start.push_back(ids.size());
+		isCircle.push_back(circle ? 1 : 0);
+	}
+};
+
+const unsigned long long EMPTY_EDGE_ID = ~0ULL;//哈希表中的空位
+
+/**  片段连接用的开放寻址哈希表：边编号 -> 以该边为端点的两个片段，内存在多次调用之间复用 **/
+struct EdgeLinkTable
+{
+	vector< unsigned long long > keys;//边编号，空位为EMPTY_EDGE_ID
+	vector< pair<int, int> > owners;//以该边为端点的两个片段，没有时为-1
+	vector< char > used;//片段是否已经连接
+	unsigned long long mask;
+	int shift;
+
+	/* 清空并按片段数量调整容量，装载率不超过一半 */
+	void reset(int pieceNum)
+	{
+		int bits = 4;
+		while ((1LL << bits) < (long long)pieceNum * 4)
+			++bits;
+		keys.assign(1ULL << bits, EMPTY_EDGE_ID);
+		owners.resize(1ULL << bits);
+		mask = (1ULL << bits) - 1;
+		shift = 64 - bits;
+		used.assign(pieceNum, 0);
+	}
+
+	/* 边编号所在的位置，不存在时为应插入的空位 */
+	unsigned long long find(unsigned long long id) const
+	{
+		unsigned long long k = (id * 0x9E3779B97F4A7C15ULL) >> shift;
+		while (keys[k] != id && keys[k] != EMPTY_EDGE_ID)
+			k = (k + 1) & mask;
+		return k;
+	}
+
+	void add(unsigned long long id, int p)
+	{
+		unsigned long long k = find(id);
+		if (keys[k] == EMPTY_EDGE_ID)
+		{
+			keys[k] = id;
+			owners[k] = make_pair(p, -1);
+		}
+		else
+		{
+			owners[k].second = p;
+		}
+	}
+
+	/* 以该边为端点的另一个片段 */
+	int getOther(unsigned long long id, int p) const
+	{
+		const pair<int, int> &owner = owners[find(id)];
+		return owner.first == p ? owner.second : owner.first;
+	}
+};
+
+/************************************************************************/
+/* Funciton: getEdgeId
+ * Description: 获得交点所在边的全局编号 = (等值编号 << EDGE_ID_LEVEL_SHIFT) | (格点编号 * 2 + 边的方向)
+ *	方向0为(i,j)-(i+1,j)边，方向1为(i,j)-(i,j+1)边，相邻cell共用的边得到相同的编号，比较端点只需一次整数比较
+ * Input:
+	edgeIndex: 交点所在边在cell中的局部编号（0,1,2,3）
+	i: cell左上角点的数组x值下标
+	j: cell左上角点的数组y值下标
+	cols: 每行格点数
+	m: 等值编号
+ * Output: 边编号
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static unsigned long long getEdgeId(int edgeIndex, int i, int j, int cols, int m)
+{
+	unsigned long long level = (unsigned long long)m << EDGE_ID_LEVEL_SHIFT;
+	switch (edgeIndex)
+	{
+	case 0:
+		return level | (((unsigned long long)i * cols + j) * 2);
+	case 1:
+		return level | (((unsigned long long)i * cols + j) * 2 + 1);
+	case 2:
+		return level | (((unsigned long long)i * cols + j + 1) * 2);
+	default:
+		return level | (((unsigned long long)(i + 1) * cols + j) * 2 + 1);
+	}
+}
+
+/************************************************************************/
+/* Funciton: getEdgeIdMiddlePoint
+ * Description: 获得边编号对应边的中点（与getMiddlePoint的结果一致）
+ * Input:
+	id: 边编号
+	cols: 每行格点数
+ * Output: isotools::Point2D  返回该边的中点
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static isotools::Point2D getEdgeIdMiddlePoint(unsigned long long id, int cols)
+{
+	unsigned long long edge = id & ((1ULL << EDGE_ID_LEVEL_SHIFT) - 1);
+	int i = (int)(edge / 2 / cols);
+	int j = (int)(edge / 2 % cols);
+	return getMiddlePoint(edge % 2 == 0 ? 0 : 1, i, j);
+}
+
+/************************************************************************/
+/* Funciton: getEdgeIdPoint
+ * Description: 由边编号插值出交点坐标，同一条边总是按相同方向插值，相邻cell得到完全相同的结果
+ * Input:
+	id: 边编号
+	data: 天气数据（vector< vector<float> >或GridView）
+	isovalue: 等值
+	table: 格点坐标查找表
+ * Output: isotools::Point2D  返回该交点的坐标
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<class Grid>
+static isotools::Point2D getEdgeIdPoint(unsigned long long id, const Grid &data, float isovalue, const CoordinateTable &table)
+{
+	int cols = getGridCols(data);
+	unsigned long long edge = id & ((1ULL << EDGE_ID_LEVEL_SHIFT) - 1);
+	int i = (int)(edge / 2 / cols);
+	int j = (int)(edge / 2 % cols);
+	return getCutPoint(edge % 2 == 0 ? 0 : 1, i, j, data, isovalue, table);
+}
+
+/************************************************************************/
+/* Funciton: interpolateEdgeId
+ * Description: 与getEdgeIdPoint相同，但插值方式在编译期确定（见interpolateVertex）
+ * Input:
+	Snap: 是否吸附到格点
+	Curvilinear: 是否曲线网格
+	其余参数同getEdgeIdPoint
+ * Output: isotools::Point2D  返回该交点的坐标
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<bool Snap, bool Curvilinear, class Grid>
+static inline isotools::Point2D interpolateEdgeId(unsigned long long id, const Grid &data, float isovalue, const CoordinateTable &table)
+{
+	int cols = getGridCols(data);
+	unsigned long long edge = id & ((1ULL << EDGE_ID_LEVEL_SHIFT) - 1);
+	int i = (int)(edge / 2 / cols);
+	int j = (int)(edge / 2 % cols);
+	if (edge % 2 == 0)
+	{
+		//竖直边与getCutPoint相同，由(i+1,j)向(i,j)插值
+		return interpolateVertex<Snap, Curvilinear>(isovalue, i + 1, j, getGridValue(data, i + 1, j), i, j, getGridValue(data, i, j), table);
+	}
+	return interpolateVertex<Snap, Curvilinear>(isovalue, i, j, getGridValue(data, i, j), i, j + 1, getGridValue(data, i, j + 1), table);
+}
+
+/************************************************************************/
+/* Funciton: fillEdgeIdPoints
+ * Description: 计算一条按边编号保存的等值线的所有交点坐标，写入isoline。
+ *	先写入结点池中的结点，再把这些结点整段转移到等值线上，池中结点不够时才新申请；
+ *	长度、叉积和外包矩形在写入时同时计算
+ * Input:
+	Snap: 是否吸附到格点
+	Curvilinear: 是否曲线网格
+	lines: 按边编号保存的等值线
+	first: 该等值线在lines.ids中的起始位置
+	last: 该等值线在lines.ids中的结束位置（不含）
+	data: 天气数据（vector< vector<float> >或GridView）
+	isovalue: 等值
+	table: 格点坐标查找表
+	isoline: 已清空的等值线
+	pool: 回收的链表结点
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<bool Snap, bool Curvilinear, class Grid>
+static void fillEdgeIdPoints(const EdgeIdLines &lines, int first, int last, const Grid &data, float isovalue, const CoordinateTable &table,
+	isotools::Isoline &isoline, list<isotools::Point2D> &pool)
+{
+	list<isotools::Point2D>::iterator node = pool.begin();
+	list<isotools::Point2D>::iterator previous = pool.end();
+	int p = first;
+	for (; p < last && node != pool.end(); ++p, ++node)
+	{
+		*node = interpolateEdgeId<Snap, Curvilinear>(lines.ids[p], data, isovalue, table);
+		if (previous != pool.end())
+		{
+			isotools::addSegmentMetrics(isoline, *previous, *node);
+		}
+		isotools::expandBox(isoline, *node);
+		previous = node;
+	}
+	isoline.points.splice(isoline.points.end(), pool, pool.begin(), node);
+	for (; p < last; ++p)
+	{
+		isotools::pushBackPoint(isoline, interpolateEdgeId<Snap, Curvilinear>(lines.ids[p], data, isovalue, table));
+	}
+}
+
+/************************************************************************/
+/* Funciton: linkEdgeIdPieces
+ * Description: 把首尾按边编号相接的片段连成等值线。每个边编号最多被两个片段共用，
+ *	通过边编号到片段的哈希表找到相邻片段，先向前找到链的起点，再向后依次连接
+ * Input:
+	pieceIds: 所有片段的边编号，依次存放
+	pieceStart: 每个片段在pieceIds中的起始位置，最后一个元素为pieceIds的长度
+	lines: 连接好的等值线追加到这里
+	linkTable: 连接用的哈希表，由调用者提供以便复用内存
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void linkEdgeIdPieces(const vector<unsigned long long> &pieceIds, const vector<int> &pieceStart, EdgeIdLines &lines, EdgeLinkTable &linkTable)
+{
+	int pieceNum = (int)pieceStart.size() - 1;
+	if (pieceNum <= 0)
+	{
+		return;
+	}
+	linkTable.reset(pieceNum);
+	for (int p = 0; p < pieceNum; ++p)
+	{
+		linkTable.add(pieceIds[pieceStart[p]], p);
+		linkTable.add(pieceIds[pieceStart[p + 1] - 1], p);
+	}
+
+	vector<char> &used = linkTable.used;
+	vector<unsigned long long> &ids = lines.ids;
+	for (int p = 0; p < pieceNum; ++p)
+	{
+		if (used[p])
+		{
+			continue;
+		}
+		//向前找到链的起点，回到自身说明构成环
+		int head = p;
+		bool headForward = true;
+		bool isCircle = false;
+		while (true)
+		{
+			unsigned long long id = headForward ? pieceIds[pieceStart[head]] : pieceIds[pieceStart[head + 1] - 1];
+			int prev = linkTable.getOther(id, head);
+			if (prev < 0)
+			{
+				break;
+			}
+			if (prev == p)
+			{
+				isCircle = true;
+				head = p;
+				headForward = true;
+				break;
+			}
+			headForward = pieceIds[pieceStart[prev + 1] - 1] == id;
+			head = prev;
+		}
+
+		//从起点依次连接，共用的边编号只保留一个
+		int lineBegin = ids.size();
+		int current = head;
+		bool currentForward = headForward;
+		while (true)
+		{
+			used[current] = 1;
+			int first = pieceStart[current], last = pieceStart[current + 1] - 1;
+			int skip = (int)ids.size() == lineBegin ? 0 : 1;
+			if (currentForward)
+			{
+				ids.insert(ids.end(), pieceIds.begin() + first + skip, pieceIds.begin() + last + 1);
+			}
+			else
+			{
+				for (int k = last - skip; k >= first; --k)
+				{
+					ids.push_back(pieceIds[k]);
+				}
+			}
+			unsigned long long tailId = ids.back();
+			int next = linkTable.getOther(tailId, current);
+			if (next < 0 || used[next])
+			{
+				break;
+			}
+			currentForward = pieceIds[pieceStart[next]] == tailId;
+			current = next;
+		}
+		if (isCircle && (int)ids.size() - lineBegin > 1 && ids.back() == ids[lineBegin])
+		{
+			ids.pop_back();
+		}
+		lines.finishLine(isCircle);
+	}
+}
+
+/**  拼接任务的临时内存 **/
+struct EdgeLinkBuffer
+{
+	vector< unsigned long long > pieceIds;//片段的边编号
+	vector< int > pieceStart;//片段的起始位置
+	EdgeLinkTable linkTable;//连接用的哈希表
+};
+
+/**  闭合等值线（环）的包含关系树：不同等值的等值线互不相交，所有环按包含关系构成一个森林，
+ *	某一等值内的包含关系沿父结点向上查找同一等值的祖先即可得到；环按(等值编号, 等值线编号)的顺序编号 **/
+struct RingTree
+{
+	vector< pair<int, int> > rings;//每个环对应的(等值编号, 等值线编号)
+	vector< vector<int> > lineRing;//每条等值线对应的环编号，不构成环的为-1
+	vector<int> parent;//直接包含该环的环编号，最外层为-1
+	vector<int> depth;//嵌套深度，最外层为0
+	vector<int> childStart;//每个环的子环在children中的起始位置，最后一个元素为children的长度
+	vector<int> children;//所有环的直接子环，依次存放
+
+	int size() const
+	{
+		return rings.size();
+	}
+
+	void clear()
+	{
+		rings.clear();
+		lineRing.clear();
+		parent.clear();
+		depth.clear();
+		childStart.assign(1, 0);
+		children.clear();
+	}
+};
+
+/**  环与某一行格点连线的一次穿越：交点在该行的水平边上，左右相邻的两个点分别在这一行的两侧 **/
+struct RingCrossing
+{
+	int row;//穿越的行
+	int col;//交点所在水平边的起始列
+	float key;//同一条边上不同等值的交点沿x增大方向的顺序
+	int ring;//环编号
+};
+
+/**  任务并行版本的上下文：持有各阶段的临时内存、结果以及回收的链表结点，
+ *	多次调用之间只清空不释放，稳定后每次调用基本不再向堆申请内存；
+ *	结果在下一次使用同一个上下文调用时失效，同一个上下文同一时间只能用于一次调用 **/
+struct ContourContext
+{
+	CoordinateTable table;//格点坐标查找表
+	vector<isotools::Edge> edgeArray;//格点上生成的等值线片段
+	vector<int> rowEdgeCount;//每一行每个等值生成的片段数量
+	vector<float> cellRange;//每个生成任务一段，存放一行cell的最小值和最大值
+	vector<int> bandStart;//拼接区域的起始行
+	vector< pair<int, int> > taskCost;//拼接任务的(工作量, 区域编号 * 等值数量 + 等值编号)
+	vector< function<void()> > tasks;//提交给调度器的任务
+	vector<EdgeLinkBuffer> linkBuffers;//每个拼接任务一份
+	vector<EdgeIdLines> bandLines;//每个（区域 × 等值）拼接出的等值线
+	vector<EdgeIdLines> levelLines;//每个等值合并后的等值线
+	vector<char> isSeamRow;//每一行是否是区域接缝
+	vector<int> lineOffset;//每个等值的第一条等值线的全局编号
+	vector<long long> pointOffset;//每条等值线的第一个点的全局编号，用于按点数划分坐标计算任务
+	vector<int> chunkStart;//每个坐标计算任务的第一条等值线的全局编号
+	list<isotools::Point2D> freeNodes;//从上一次结果回收的链表结点
+	vector< list<isotools::Point2D> > nodePools;//分给每个坐标计算任务的链表结点
+	vector< vector<isotools::Isoline>> pathLinesV;//结果
+	bool buildIndex;//是否在计算坐标时同时建立结果的空间索引
+	IsolineIndex index;//结果的空间索引，buildIndex为false时为空
+	bool buildNesting;//是否统一等值线方向并建立环的包含关系树
+	RingTree ringTree;//环的包含关系树，buildNesting为false时为空
+	vector< vector<RingCrossing> > levelCrossings;//建树用：每个等值的环穿越各行的位置
+	vector<RingCrossing> rowCrossings;//建树用：按行排列的穿越位置
+	vector<int> rowCrossingStart;//建树用：每一行的穿越位置在rowCrossings中的起始位置
+	vector<int> ringTopRow;//建树用：每个环穿越的最小行号
+	vector<float> thresholds;//每个等值在比较域中的阈值
+	bool canonicalOrder;//是否按规范顺序输出，结果与线程数和区域划分无关
+	vector< pair<unsigned long long, int> > lineKeys;//规范化用：每条等值线的(最小边编号, 全局编号)
+	vector< pair<unsigned long long, int> > lineKeyBuffer;//规范化用：并行排序的归并缓冲
+	vector<int> lineMinPos;//规范化用：每条等值线最小边编号在ids中的位置
+	vector<EdgeIdLines> canonicalLines;//规范化用：按规范顺序重排后的等值线，与levelLines交换
+
+	ContourContext() : buildIndex(false), buildNesting(false), canonicalOrder(false) {}
+};
+
+/************************************************************************/
+/* Funciton: recycleContour
+ * Description: 把上一次结果中所有点的链表结点回收到空闲链表，整条链表一次转移，不逐个遍历结点
+ * Input:
+	context: 上下文
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void recycleContour(ContourContext &context)
+{
+	list<isotools::Point2D> &freeNodes = context.freeNodes;
+	int poolsNum = context.nodePools.size();
+	for (int c = 0; c < poolsNum; ++c)
+	{
+		freeNodes.splice(freeNodes.end(), context.nodePools[c]);
+	}
+	vector< vector<isotools::Isoline>> &pathLinesV = context.pathLinesV;
+	int levelsNum = pathLinesV.size();
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		int linesNum = pathLinesV[m].size();
+		for (int n = 0; n < linesNum; ++n)
+		{
+			freeNodes.splice(freeNodes.end(), pathLinesV[m][n].points);
+		}
+	}
+}
+
+/************************************************************************/
+/* Funciton: distributeNodes
+ * Description: 按每个坐标计算任务需要的点数，从空闲链表中分出结点放入各任务的结点池，
+ *	空闲结点不够时后面的任务分得的少，由任务自己申请补足
+ * Input:
+	context: 上下文，chunkStart与pointOffset已经计算好
+	chunksNum: 坐标计算任务的数量
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void distributeNodes(ContourContext &context, int chunksNum)
+{
+	list<isotools::Point2D> &freeNodes = context.freeNodes;
+	context.nodePools.resize(chunksNum);
+	size_t freeNum = freeNodes.size();
+	for (int c = 0; c < chunksNum && freeNum > 0; ++c)
+	{
+		size_t need = context.pointOffset[context.chunkStart[c + 1]] - context.pointOffset[context.chunkStart[c]];
+		if (need > freeNum)
+		{
+			need = freeNum;
+		}
+		list<isotools::Point2D>::iterator last = freeNodes.begin();
+		advance(last, need);
+		context.nodePools[c].splice(context.nodePools[c].end(), freeNodes, freeNodes.begin(), last);
+		freeNum -= need;
+	}
+}
+
+/************************************************************************/
+/* Funciton: getEdgeIdRowSide
+ * Description: 判断边编号对应的交点在第row行格点连线的哪一侧；竖直边上的交点总在两行之间，
+ *	水平边上的交点与环相邻的点不会在同一行，因此不会落在连线上
+ * Input:
+	id: 边编号
+	cols: 每行格点数
+	row: 行号
+ * Output: 在行号较大的一侧返回1，否则返回-1
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int getEdgeIdRowSide(unsigned long long id, int cols, int row)
+{
+	unsigned long long edge = id & ((1ULL << EDGE_ID_LEVEL_SHIFT) - 1);
+	int i = (int)(edge / 2 / cols);
+	if (edge % 2 == 1)
+	{
+		return i > row ? 1 : -1;
+	}
+	return i >= row ? 1 : -1;
+}
+
+/************************************************************************/
+/* Funciton: orientEdgeIdLine
+ * Description: 统一等值线方向：沿等值线前进时，数值不低于等值的一侧在输出坐标系的左侧，
+ *	因此环的有向面积为正表示环内数值较高（如高压中心），为负表示环内数值较低（如低压中心）。
+ *	第一段穿过的cell中，两个交点所在边的中点连线与真实线段对cell顶点的划分相同，
+ *	用第一条边上较高的端点相对这条连线的位置判断方向，不需要计算坐标
+ * Input:
+	lines: 按边编号保存的等值线，需要时直接反转
+	k: 等值线编号
+	data: 天气数据（vector< vector<float> >或GridView）
+	isovalue: 等值
+	orientation: 输出坐标系与数组下标坐标系（x为列，y为行）方向相同时为1，镜像时为-1
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<class Grid>
+static void orientEdgeIdLine(EdgeIdLines &lines, int k, const Grid &data, float isovalue, float orientation)
+{
+	int first = lines.start[k], last = lines.start[k + 1];
+	if (last - first < 2)
+	{
+		return;
+	}
+	int cols = getGridCols(data);
+	unsigned long long mask = (1ULL << EDGE_ID_LEVEL_SHIFT) - 1;
+	unsigned long long u = lines.ids[first] & mask, v = lines.ids[first + 1] & mask;
+	int ui = (int)(u / 2 / cols), uj = (int)(u / 2 % cols);
+	int vi = (int)(v / 2 / cols), vj = (int)(v / 2 % cols);
+	//边中点在下标坐标系中的位置，x为列，y为行
+	double ux = uj + (u % 2 == 1 ? 0.5 : 0), uy = ui + (u % 2 == 0 ? 0.5 : 0);
+	double vx = vj + (v % 2 == 1 ? 0.5 : 0), vy = vi + (v % 2 == 0 ? 0.5 : 0);
+	int hi = ui, hj = uj;
+	if (getGridValue(data, ui, uj) < isovalue)
+	{
+		if (u % 2 == 0)
+			hi = ui + 1;
+		else
+			hj = uj + 1;
+	}
+	double cross = (vx - ux) * (hi - uy) - (vy - uy) * (hj - ux);
+	if ((cross > 0) != (orientation > 0))
+	{
+		reverse(lines.ids.begin() + first, lines.ids.begin() + last);
+	}
+}
+
+static bool compareRingCrossing(const RingCrossing &a, const RingCrossing &b)
+{
+	if (a.col != b.col)
+		return a.col < b.col;
+	return a.key < b.key;
+}
+
+/************************************************************************/
+/* Funciton: buildRingTree
+ * Description: 统一所有等值线的方向，并建立环的包含关系树。
+ *	每个环至少包围一个格点，因此至少穿越一行格点连线，穿越点都在该行的水平边上；
+ *	同一行的穿越点按列排序，同一条边上不同等值的交点按等值和边两端的大小关系排序，全程不需要浮点坐标。
+ *	各行从左到右扫描：遇到栈顶的环表示离开该环，否则表示进入，进入时的栈顶就是直接包含它的环；
+ *	每个环只在它穿越的最小行上记录父结点。排序总量为O(n log n)，各行相互独立并行处理
+ * Input:
+	context: 上下文，levelLines已经拼接完成，结果写入context.ringTree
+	data: 天气数据（vector< vector<float> >或GridView）
+	isovalues: 等值线值数组
+	scheduler: 任务调度器
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<class Grid>
+static void buildRingTree(ContourContext &context, const Grid &data, vector<float> &isovalues, TaskScheduler *scheduler)
+{
+	RingTree &tree = context.ringTree;
+	tree.clear();
+	int levelsNum = isovalues.size();
+	int rows = getGridRows(data);
+	int cols = getGridCols(data);
+	float orientation = context.table.orientation;
+
+	tree.lineRing.resize(levelsNum);
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		EdgeIdLines &lines = context.levelLines[m];
+		int linesNum = lines.size();
+		tree.lineRing[m].assign(linesNum, -1);
+		for (int k = 0; k < linesNum; ++k)
+		{
+			if (lines.isCircle[k])
+			{
+				tree.lineRing[m][k] = tree.rings.size();
+				tree.rings.push_back(make_pair(m, k));
+			}
+		}
+	}
+	int ringsNum = tree.rings.size();
+	vector<int> &topRow = context.ringTopRow;
+	topRow.assign(ringsNum, rows);
+
+	//每个等值一个任务：统一方向，并找出环穿越各行的位置
+	if ((int)context.levelCrossings.size() < levelsNum)
+	{
+		context.levelCrossings.resize(levelsNum);
+	}
+	auto collect = [&](int m)
+	{
+		EdgeIdLines &lines = context.levelLines[m];
+		vector<RingCrossing> &crossings = context.levelCrossings[m];
+		crossings.clear();
+		int linesNum = lines.size();
+		for (int k = 0; k < linesNum; ++k)
+		{
+			orientEdgeIdLine(lines, k, data, isovalues[m], orientation);
+			int ring = tree.lineRing[m][k];
+			if (ring < 0)
+			{
+				continue;
+			}
+			int first = lines.start[k];
+			int count = lines.start[k + 1] - first;
+			for (int p = 0; p < count; ++p)
+			{
+				unsigned long long edge = lines.ids[first + p] & ((1ULL << EDGE_ID_LEVEL_SHIFT) - 1);
+				if (edge % 2 == 0)
+				{
+					continue;
+				}
+				int i = (int)(edge / 2 / cols);
+				int j = (int)(edge / 2 % cols);
+				int prevSide = getEdgeIdRowSide(lines.ids[first + (p + count - 1) % count], cols, i);
+				int nextSide = getEdgeIdRowSide(lines.ids[first + (p + 1) % count], cols, i);
+				if (prevSide == nextSide)
+				{
+					//只是碰到这一行，没有穿越
+					continue;
+				}
+				RingCrossing crossing;
+				crossing.row = i;
+				crossing.col = j;
+				crossing.key = getGridValue(data, i, j) < getGridValue(data, i, j + 1) ? isovalues[m] : -isovalues[m];
+				crossing.ring = ring;
+				crossings.push_back(crossing);
+				if (i < topRow[ring])
+				{
+					topRow[ring] = i;
+				}
+			}
+		}
+	};
+	vector< function<void()> > &tasks = context.tasks;
+	tasks.clear();
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		tasks.push_back([&collect, m]() { collect(m); });
+	}
+	scheduler->runTasks(tasks);
+
+	//按行计数排序，填充时rowStart[i]后移到下一行的起点，最后整体移回
+	vector<int> &rowStart = context.rowCrossingStart;
+	rowStart.assign(rows + 1, 0);
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		vector<RingCrossing> &crossings = context.levelCrossings[m];
+		int crossingsNum = crossings.size();
+		for (int c = 0; c < crossingsNum; ++c)
+		{
+			++rowStart[crossings[c].row + 1];
+		}
+	}
+	for (int i = 0; i < rows; ++i)
+	{
+		rowStart[i + 1] += rowStart[i];
+	}
+	vector<RingCrossing> &rowCrossings = context.rowCrossings;
+	rowCrossings.resize(rowStart[rows]);
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		vector<RingCrossing> &crossings = context.levelCrossings[m];
+		int crossingsNum = crossings.size();
+		for (int c = 0; c < crossingsNum; ++c)
 		{
-			pathLines[i][j1].startPoint = pathLines[i][j2].endPoint;
-			for (int kk = 0; kk < size2; ++kk)
-			{
-				pathLines[i][j1].points.push_front(pathLines[i][j2].points.front());
-				pathLines[i][j2].points.pop_front();
-			}
-			pathLines[i].erase(pathLines[i].begin() + j2);
+			rowCrossings[rowStart[crossings[c].row]++] = crossings[c];
 		}
-		return true;
 	}
-	else if (pathLines[i][j1].startPoint == pathLines[i][j2].endPoint)//头尾
+	for (int i = rows; i > 0; --i)
 	{
-		if (size1 < size2)//把j1的点添加到j2
+		rowStart[i] = rowStart[i - 1];
+	}
+	rowStart[0] = 0;
+
+	//每行从左到右扫描
+	tree.parent.assign(ringsNum, -1);
+	parallelFor(scheduler, 0, rows, rows / (scheduler->getThreadNum() * 8), [&](int rowBegin, int rowEnd)
+	{
+		vector<int> stack;
+		for (int i = rowBegin; i < rowEnd; ++i)
 		{
-			pathLines[i][j2].endPoint = pathLines[i][j1].endPoint;
-			for (int kk = 0; kk < size1; ++kk)
+			if (rowStart[i] == rowStart[i + 1])
 			{
-				pathLines[i][j2].points.push_back(pathLines[i][j1].points.front());
-				pathLines[i][j1].points.pop_front();
+				continue;
 			}
-			pathLines[i].erase(pathLines[i].begin() + j1);
-		}
-		else//把j2的点添加到j1
-		{
-			pathLines[i][j1].startPoint = pathLines[i][j1].startPoint;
-			for (int kk = 0; kk < size2; ++kk)
+			sort(rowCrossings.begin() + rowStart[i], rowCrossings.begin() + rowStart[i + 1], compareRingCrossing);
+			stack.clear();
+			for (int c = rowStart[i]; c < rowStart[i + 1]; ++c)
 			{
-				pathLines[i][j1].points.push_front(pathLines[i][j2].points.back());
-				pathLines[i][j2].points.pop_back();
+				int ring = rowCrossings[c].ring;
+				if (!stack.empty() && stack.back() == ring)
+				{
+					stack.pop_back();
+					continue;
+				}
+				if (topRow[ring] == i)
+				{
+					tree.parent[ring] = stack.empty() ? -1 : stack.back();
+				}
+				stack.push_back(ring);
 			}
-			pathLines[i].erase(pathLines[i].begin() + j2);
 		}
-		return true;
-	}
-	else if (pathLines[i][j1].endPoint == pathLines[i][j2].endPoint)//尾尾
+	}, &tasks);
+
+	//嵌套深度：先向上找到已知深度的祖先，再沿原路写入
+	tree.depth.assign(ringsNum, -1);
+	for (int r = 0; r < ringsNum; ++r)
 	{
-		if (size1 < size2)//把j1的点添加到j2
+		int steps = 0;
+		int a = r;
+		while (a >= 0 && tree.depth[a] < 0)
 		{
-			pathLines[i][j2].endPoint = pathLines[i][j1].startPoint;
-			for (int kk = 0; kk < size1; ++kk)
-			{
-				pathLines[i][j2].points.push_back(pathLines[i][j1].points.back());
-				pathLines[i][j1].points.pop_back();
-			}
-			pathLines[i].erase(pathLines[i].begin() + j1);
+			++steps;
+			a = tree.parent[a];
 		}
-		else//把j2的点添加到j1
+		int d = (a < 0 ? -1 : tree.depth[a]) + steps;
+		for (a = r; steps > 0; --steps, --d)
 		{
-			pathLines[i][j1].endPoint = pathLines[i][j2].startPoint;
-			for (int kk = 0; kk < size2; ++kk)
-			{
-				pathLines[i][j1].points.push_back(pathLines[i][j2].points.back());
-				pathLines[i][j2].points.pop_back();
-			}
-			pathLines[i].erase(pathLines[i].begin() + j2);
+			tree.depth[a] = d;
+			a = tree.parent[a];
 		}
-		return true;
 	}
-	else if (pathLines[i][j1].endPoint == pathLines[i][j2].startPoint)//尾头
+
+	//子环按环编号顺序存放
+	tree.childStart.assign(ringsNum + 1, 0);
+	for (int r = 0; r < ringsNum; ++r)
 	{
-		if (size1 < size2)//把j1的点添加到j2
+		if (tree.parent[r] >= 0)
 		{
-			pathLines[i][j2].startPoint = pathLines[i][j1].startPoint;
-			for (int kk = 0; kk < size1; ++kk)
-			{
-				pathLines[i][j2].points.push_front(pathLines[i][j1].points.back());
-				pathLines[i][j1].points.pop_back();
-			}
-			pathLines[i].erase(pathLines[i].begin() + j1);
+			++tree.childStart[tree.parent[r] + 1];
 		}
-		else//把j2的点添加到j1
+	}
+	for (int r = 0; r < ringsNum; ++r)
+	{
+		tree.childStart[r + 1] += tree.childStart[r];
+	}
+	tree.children.resize(tree.childStart[ringsNum]);
+	for (int r = 0; r < ringsNum; ++r)
+	{
+		if (tree.parent[r] >= 0)
 		{
-			pathLines[i][j1].endPoint = pathLines[i][j2].endPoint;
-			for (int kk = 0; kk < size2; ++kk)
-			{
-				pathLines[i][j1].points.push_back(pathLines[i][j2].points.front());
-				pathLines[i][j2].points.pop_front();
-			}
-			pathLines[i].erase(pathLines[i].begin() + j2);
+			tree.children[tree.childStart[tree.parent[r]]++] = r;
 		}
-		return true;
 	}
-	return false;
+	for (int r = ringsNum; r > 0; --r)
+	{
+		tree.childStart[r] = tree.childStart[r - 1];
+	}
+	tree.childStart[0] = 0;
 }
 
 /************************************************************************/
-/* Funciton: isMergeTwoArea
- * Description: 进行区域合并
+/* Funciton: isRingInside
+ * Description: 判断环inner是否在环outer内部（沿父结点向上查找）
  * Input:
-	mergePos: 表示两个区域相邻的边界区域
-	pathLinesV: 第一个区域的等值线集合
-	pathLinesV1: 第二个区域的等值线集合
-	pathLinesTemp: 临时存放等值线的集合
+	tree: 环的包含关系树
+	inner: 内部的环编号
+	outer: 外部的环编号
+ * Output: inner在outer内部时返回true，二者相同时返回false
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static bool isRingInside(const RingTree &tree, int inner, int outer)
+{
+	if (tree.depth[inner] <= tree.depth[outer])
+	{
+		return false;
+	}
+	while (tree.depth[inner] > tree.depth[outer])
+	{
+		inner = tree.parent[inner];
+	}
+	return inner == outer;
+}
+
+/************************************************************************/
+/* Funciton: findRingAncestor
+ * Description: 沿父结点向上查找第一个属于指定等值的环，用于得到某一等值内的包含关系
+ * Input:
+	tree: 环的包含关系树
+	ring: 环编号
+	level: 等值编号
+ * Output: 最近的属于该等值的祖先环编号，没有时返回-1
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static int findRingAncestor(const RingTree &tree, int ring, int level)
+{
+	int a = tree.parent[ring];
+	while (a >= 0 && tree.rings[a].first != level)
+	{
+		a = tree.parent[a];
+	}
+	return a;
+}
+
+/************************************************************************/
+/* Funciton: canonicalizeEdgeIdLines
+ * Description: 把拼接结果整理为规范形式，使输出与线程数、区域划分和片段的拼接顺序无关：
+ *	每条等值线以它经过的最小边编号为键（每条边只属于一条等值线，键互不相同），同一等值内按键从小到大排列；
+ *	环从最小边编号开始，开放的等值线从编号较小的端点开始。buildNesting为true时先统一方向，
+ *	此时只旋转环的起点，不改变方向；否则环朝编号较小的相邻边前进。
+ *	边编号的高位是等值编号，所有等值的键一起做一次并行排序，各条等值线的重排也并行执行
+ * Input:
+	context: 上下文，levelLines已经拼接完成，整理后的结果写回levelLines
+	data: 天气数据（vector< vector<float> >或GridView）
+	isovalues: 等值线值数组
+	scheduler: 任务调度器
  * Output: void
  * Author: gcdofree
- * Date: 2014.11.3
+ * Date: 2026.10.19
 /************************************************************************/
-static void isMergeTwoArea(int mergePos, vector< vector<isotools::Isoline>> &pathLinesV,
-	vector< vector<isotools::Isoline>> &pathLinesV1, vector< vector<isotools::Isoline>> &pathLinesTemp)
+template<class Grid>
+static void canonicalizeEdgeIdLines(ContourContext &context, const Grid &data, vector<float> &isovalues, TaskScheduler *scheduler)
 {
-	pathLinesTemp.clear();
-	//对局部拼接结果进行合并
-	//pathLinesV + pathLinesV1
-	//pathLinesV查找边界片段，并加入到pathLinesTemp中
-	int pathLinesSize1_i = pathLinesV.size();
-	pathLinesTemp.resize(pathLinesSize1_i);
-	for (int i = 0; i < pathLinesSize1_i; ++i)
+	int levelsNum = isovalues.size();
+	int threadNum = scheduler->getThreadNum();
+	vector<int> &lineOffset = context.lineOffset;
+	lineOffset.assign(levelsNum + 1, 0);
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		lineOffset[m + 1] = lineOffset[m] + context.levelLines[m].size();
+	}
+	int linesNum = lineOffset[levelsNum];
+	vector< pair<unsigned long long, int> > &lineKeys = context.lineKeys;
+	vector<int> &lineMinPos = context.lineMinPos;
+	lineKeys.resize(linesNum);
+	lineMinPos.resize(linesNum);
+	float orientation = context.table.orientation;
+	parallelFor(scheduler, 0, linesNum, linesNum / (threadNum * 8), [&](int lineBegin, int lineEnd)
 	{
-		int pathLinesSize1_j = pathLinesV[i].size();
-		for (int j = 0; j < pathLinesSize1_j; j++)
+		int m = upper_bound(lineOffset.begin(), lineOffset.end(), lineBegin) - lineOffset.begin() - 1;
+		for (int n = lineBegin; n < lineEnd; ++n)
 		{
-			if ((pathLinesV[i][j].startPoint.x > mergePos - 1 && pathLinesV[i][j].startPoint.x <= mergePos) ||
-				pathLinesV[i][j].endPoint.x > mergePos - 1 && pathLinesV[i][j].endPoint.x <= mergePos)
+			while (n >= lineOffset[m + 1])
 			{
-				if (!pathLinesV[i][j].isCircle)
-				{
-					pathLinesV[i][j].isBorder = true;
-					pathLinesTemp[i].push_back(pathLinesV[i][j]);
-					pathLinesV[i].erase(pathLinesV[i].begin() + j);
-					--j;
-					--pathLinesSize1_j;
-				}
+				++m;
+			}
+			EdgeIdLines &lines = context.levelLines[m];
+			int k = n - lineOffset[m];
+			if (context.buildNesting)
+			{
+				orientEdgeIdLine(lines, k, data, isovalues[m], orientation);
 			}
+			int minPos = min_element(lines.ids.begin() + lines.start[k], lines.ids.begin() + lines.start[k + 1]) - lines.ids.begin();
+			lineKeys[n] = make_pair(lines.ids[minPos], n);
+			lineMinPos[n] = minPos;
 		}
+	});
+	parallelSort(scheduler, lineKeys, context.lineKeyBuffer, less< pair<unsigned long long, int> >());
+
+	//排序后第m个等值的等值线仍然在[lineOffset[m], lineOffset[m + 1])内，先按新顺序计算起始位置
+	if ((int)context.canonicalLines.size() < levelsNum)
+	{
+		context.canonicalLines.resize(levelsNum);
 	}
-	//pathLinesV1查找边界片段，并加入到pathLinesTemp中
-	for (int i = 0; i < pathLinesSize1_i; ++i)
+	for (int m = 0; m < levelsNum; ++m)
 	{
-		int pathLinesSize2_j = pathLinesV1[i].size();
-		for (int j = 0; j < pathLinesSize2_j; j++)
+		EdgeIdLines &lines = context.levelLines[m];
+		EdgeIdLines &sorted = context.canonicalLines[m];
+		int levelLinesSize = lines.size();
+		sorted.ids.resize(lines.ids.size());
+		sorted.start.resize(levelLinesSize + 1);
+		sorted.isCircle.resize(levelLinesSize);
+		sorted.start[0] = 0;
+		for (int k = 0; k < levelLinesSize; ++k)
 		{
-			if ((pathLinesV1[i][j].startPoint.x > mergePos - 1 && pathLinesV1[i][j].startPoint.x <= mergePos) ||
-				pathLinesV1[i][j].endPoint.x > mergePos - 1 && pathLinesV1[i][j].endPoint.x <= mergePos)
-			{
-				if (!pathLinesV1[i][j].isCircle)
-				{
-					pathLinesV1[i][j].isBorder = true;
-					pathLinesTemp[i].push_back(pathLinesV1[i][j]);
-					pathLinesV1[i].erase(pathLinesV1[i].begin() + j);
-					--j;
-					--pathLinesSize2_j;
-				}
-			}
+			int source = lineKeys[lineOffset[m] + k].second - lineOffset[m];
+			sorted.start[k + 1] = sorted.start[k] + lines.start[source + 1] - lines.start[source];
+			sorted.isCircle[k] = lines.isCircle[source];
 		}
 	}
-
-	//对pathLinesTemp中的片段进行拼接
-	for (int i = 0; i < pathLinesSize1_i; ++i)
+	parallelFor(scheduler, 0, linesNum, linesNum / (threadNum * 8), [&](int lineBegin, int lineEnd)
 	{
-		int pathLinesSizej = pathLinesTemp[i].size();
-		for (int j = 0; j < pathLinesSizej - 1; ++j)
+		int m = upper_bound(lineOffset.begin(), lineOffset.end(), lineBegin) - lineOffset.begin() - 1;
+		for (int n = lineBegin; n < lineEnd; ++n)
 		{
-			for (int k = j + 1; k < pathLinesSizej; ++k)
+			while (n >= lineOffset[m + 1])
 			{
-				bool isMerge = isMergeTwoIsoLine(i, j, k, pathLinesTemp[i][j].points.size(), pathLinesTemp[i][k].points.size(), pathLinesTemp);
-				if (isMerge)
-				{
-					--j;
-					--pathLinesSizej;
-					break;
-				}
+				++m;
+			}
+			EdgeIdLines &lines = context.levelLines[m];
+			EdgeIdLines &sorted = context.canonicalLines[m];
+			int source = lineKeys[n].second;
+			int k = source - lineOffset[m];
+			vector<unsigned long long>::iterator first = lines.ids.begin() + lines.start[k];
+			vector<unsigned long long>::iterator last = lines.ids.begin() + lines.start[k + 1];
+			vector<unsigned long long>::iterator target = sorted.ids.begin() + sorted.start[n - lineOffset[m]];
+			if (!lines.isCircle[k])
+			{
+				if (context.buildNesting || *first < *(last - 1))
+					copy(first, last, target);
+				else
+					reverse_copy(first, last, target);
+				continue;
+			}
+			vector<unsigned long long>::iterator minIt = lines.ids.begin() + lineMinPos[source];
+			rotate_copy(first, minIt, last, target);
+			//旋转后target[1]是原方向的下一条边，末尾是上一条边
+			int size = last - first;
+			if (!context.buildNesting && size > 2 && target[size - 1] < target[1])
+			{
+				reverse(target + 1, target + size);
 			}
 		}
-		//将拼接结果加入到pathLinesV
-		for (int j = 0; j < pathLinesSizej; ++j)
-		{
-			pathLinesV[i].push_back(pathLinesTemp[i][j]);
-		}
-		//将pathLinesV1中的等值线加入到pathLinesV
-		pathLinesSizej = pathLinesV1[i].size();
-		for (int j = 0; j < pathLinesSizej; ++j)
-		{
-			pathLinesV[i].push_back(pathLinesV1[i][j]);
-		}
+	});
+	for (int m = 0; m < levelsNum; ++m)
+	{
+		swap(context.levelLines[m], context.canonicalLines[m]);
 	}
 }
 
 /************************************************************************/
-/* Funciton: doMarchingSquaresAccelerateOMP 【此方法适用于 多核CPU】
- * Description: Marching Squares 算法的实现，首先计算生成所有的格点上短等值线，之后再进行合并拼接
+/* Funciton: doMarchingSquaresAccelerateTask 【此方法适用于 多核CPU，运行在可插拔的任务调度器上】
+ * Description: Marching Squares 算法的实现，与doMarchingSquaresAccelerateOMP流程相同，
+ *	但生成、拼接与区域合并都拆分为细粒度任务提交给TaskScheduler，多个并发请求可以共享同一个线程池；
+ *	拼接与区域合并同时在空间（行区域）和等值两个维度上并行。
+ *	拼接与合并只使用整数边编号，等值线的坐标在最后统一并行计算，每个交点只插值一次。
+ *	所有临时内存和结果都由context持有，重复使用同一个context时不再重新分配。
+ *	data可以是GridView包装的int16、float16等压缩数据：等值事先换算为比较域中的阈值，
+ *	分类时直接比较存储值，只在鞍点判断、缺测判断和插值时还原，结果与先展开为float再计算完全一致。
+ *	分类与插值的内层函数按等值数量、鞍点规则、是否吸附到格点和坐标方式在编译期特化，每行或每条等值线选择一次
  * Input:
-	data: 天气数据值二维数组
+	context: 上下文，每个并发请求使用各自的上下文
+	data: 天气数据（vector< vector<float> >或GridView）
 	isovalues: 等值线值数组
-	pathLinesV: 返回该等值数组下的所有各条等值线数组的集合
 	startLongitude: 起始经度（起始x坐标）
 	longitudeGridSpace: 经度间隔（x坐标间隔）
 	startLatitude: 起始纬度（起始y坐标）
 	latitudeGridSpace: 纬度间隔（y坐标间隔）
 	maxGridValue: 网格点中的最大值
 	minGridValue: 网格点中的最小值
-* Output: void
+	scheduler: 任务调度器，为NULL时使用默认的work-stealing线程池
+	options: 缺测值、格点坐标等可选设置，为NULL时不判断缺测并使用规则网格
+* Output: 该等值数组下的所有各条等值线数组的集合（即context.pathLinesV）；context.buildIndex为true时同时建立context.index，
+*	context.buildNesting为true时统一等值线方向并建立context.ringTree；
+*	context.canonicalOrder为true时按规范顺序和起点输出，相同输入在任意线程数、任意调度器下得到逐位相同的结果
 * Author: gcdofree
-* Date: 2014.11.3
+* Date: 2026.10.19
 /************************************************************************/
-static void doMarchingSquaresAccelerateOMP(vector<vector<float> > &data, vector<float> &isovalues, vector< vector<isotools::Isoline>> &pathLinesV,
-	float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace, float maxGridValue, float minGridValue)
+template<class Grid>
+static vector< vector<isotools::Isoline>> &doMarchingSquaresAccelerateTask(ContourContext &context, const Grid &data, vector<float> &isovalues,
+	float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace, float maxGridValue, float minGridValue,
+	TaskScheduler *scheduler = NULL, const ContourOptions *options = NULL)
 {
-	int edgeNum = 0;
-
-	//利用OpenMP加速。在拼接阶段，分四个section同步进行
-	vector< vector<isotools::Isoline>> pathLinesV1, pathLinesV2, pathLinesV3, pathLinesTemp;
-	pathLinesV.clear();
-	pathLinesV1.clear();
-	pathLinesV2.clear();
-	pathLinesV3.clear();
-	pathLinesTemp.clear();
-
-	isotools::Edge *edgeArray;//用于存放生成的等值线片段
-	vector<vector<int>> pathLinesHit, pathLinesHit1, pathLinesHit2, pathLinesHit3;
+	if (scheduler == NULL)
+	{
+		scheduler = getDefaultScheduler();
+	}
+	int threadNum = scheduler->getThreadNum();
+	context.index.clear();
+	context.ringTree.clear();
+	recycleContour(context);
+	vector< vector<isotools::Isoline>> &pathLinesV = context.pathLinesV;
+	vector< function<void()> > &tasks = context.tasks;
 
 	int isovaluesNum = isovalues.size();
 	for (int m = 0; m < isovaluesNum; ++m)
@@ -1138,119 +3069,418 @@ static void doMarchingSquaresAccelerateOMP(vector<vector<float> > &data, vector<
 			isovaluesNum--;
 		}
 	}
-	
-	pathLinesV.resize(isovaluesNum);
-	pathLinesV1.resize(isovaluesNum);
-	pathLinesV2.resize(isovaluesNum);
-	pathLinesV3.resize(isovaluesNum);
-	pathLinesTemp.resize(isovaluesNum);
-	pathLinesHit.resize(isovaluesNum);
-	pathLinesHit1.resize(isovaluesNum);
-	pathLinesHit2.resize(isovaluesNum);
-	pathLinesHit3.resize(isovaluesNum);
-
-	//首先生成所有格点上短的等值线
-
-	int dataSize_i = data.size() - 1;
-	int dataSize_j = data[0].size() - 1;
-
-	int edgeSize = dataSize_i*dataSize_j*isovaluesNum * 2;
-
-	edgeArray = new isotools::Edge[edgeSize];
+	resetLevels(pathLinesV, isovaluesNum);
 
-#pragma omp parallel for	
-	for (int i = 0; i < edgeSize; ++i)
+	int dataSize_i = getGridRows(data) - 1;
+	int dataSize_j = dataSize_i > 0 ? getGridCols(data) - 1 : 0;
+	if (isovaluesNum == 0 || dataSize_i <= 0 || dataSize_j <= 0)
 	{
-		edgeArray[i].isovalue = 999;//初始化为999
+		return pathLinesV;
 	}
-
-#pragma omp parallel for	
-	for (int i = 0; i<dataSize_i; ++i)//逐行扫
+	vector<float> &thresholds = context.thresholds;
+	thresholds.resize(isovaluesNum);
+	for (int m = 0; m < isovaluesNum; ++m)
 	{
-		for (int j = 0; j<dataSize_j; ++j)//逐列扫
-		{
-			doGridCalcOMP(data, isovalues, i, j, isovaluesNum, dataSize_j, edgeArray);
-		}
+		thresholds[m] = quantizeIsovalue(data, isovalues[m]);
 	}
 
-	int edgeSize1 = edgeSize / 4;
-	int edgeSize2 = edgeSize / 2;
-	int edgeSize3 = edgeSize / 4 * 3;
-	//开始进行局部拼接，分为4个section，使用OpenMP同步进行
-#pragma omp parallel sections
+	ContourStats *stats = options != NULL ? options->stats : NULL;
+	double phaseTime = stats != NULL ? getTimeMs() : 0;
+	CoordinateTable &table = context.table;
+	buildCoordinateTable(dataSize_i + 1, dataSize_j + 1, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace, options, table);
+
+	int rowEdgeSize = dataSize_j * isovaluesNum * 2;//每一行格点对应的临时边数量
+	int edgeSize = dataSize_i * rowEdgeSize;
+	context.edgeArray.resize(edgeSize);
+	isotools::Edge *edgeArray = context.edgeArray.data();//用于存放生成的等值线片段
+	vector<int> &rowEdgeCount = context.rowEdgeCount;//每一行每个等值生成的临时边数量，用于估计拼接任务的工作量
+	rowEdgeCount.assign(dataSize_i * isovaluesNum, 0);
+
+	//首先按行块生成所有格点上短的等值线，初始化与生成在同一个任务中完成
+	//任务函数只捕获一个引用，放得进std::function的内部存储，提交任务时不申请内存
+	int rowGrain = dataSize_i / (threadNum * 4);
+	if (rowGrain < 1)
+	{
+		rowGrain = 1;
+	}
+	context.cellRange.resize((size_t)((dataSize_i + rowGrain - 1) / rowGrain) * dataSize_j * 2);
+	//块取值范围索引与数据大小不一致时不使用
+	const BlockRangeIndex *blockIndex = options != NULL ? options->blockIndex : NULL;
+	if (blockIndex != NULL && (blockIndex->cellRows != dataSize_i || blockIndex->cellCols != dataSize_j || blockIndex->blockSize < 1))
+	{
+		blockIndex = NULL;
+	}
+	//按等值数量和鞍点规则选择编译期特化的版本
+	typename RowCalcTask<Grid>::Func rowCalcTask = selectRowCalcTask<Grid>(isovaluesNum, options != NULL ? options->saddleRule : SADDLE_CENTER);
+	auto generate = [&](int rowBegin, int rowEnd)
 	{
-#pragma omp section
+		float *cellMin = &context.cellRange[(size_t)(rowBegin / rowGrain) * dataSize_j * 2];
+		float *cellMax = cellMin + dataSize_j;
+		//初始化、生成与计数只在[colBegin, colEnd)内进行，拼接阶段也只读取这些cell
+		auto scanCells = [&](int i, int colBegin, int colEnd)
 		{
-			for (int i = 0; i < edgeSize1; ++i)
+			int edgeBegin = (i * dataSize_j + colBegin) * isovaluesNum * 2;
+			int edgeEnd = (i * dataSize_j + colEnd) * isovaluesNum * 2;
+			for (int k = edgeBegin; k < edgeEnd; ++k)
+			{
+				edgeArray[k].m = -1;//初始化为-1，表示该位置没有生成边
+			}
+			calcRowRange(data, i, options, cellMin, cellMax, colBegin, colEnd);
+			rowCalcTask(data, isovalues, thresholds, i, colBegin, colEnd, isovaluesNum, dataSize_j, edgeArray, cellMin, cellMax);
+			for (int k = edgeBegin; k < edgeEnd; ++k)
 			{
-				if (edgeArray[i].isovalue != 999)
+				if (edgeArray[k].m >= 0)
 				{
-					addPointToLineAccelerate(edgeArray[i].edgeIndex1, edgeArray[i].edgeIndex2, edgeArray[i].i, edgeArray[i].j,
-						data, pathLinesHit[edgeArray[i].m], edgeArray[i].isovalue, pathLinesV[edgeArray[i].m],
-						startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
+					++rowEdgeCount[i * isovaluesNum + edgeArray[k].m];
 				}
 			}
-		}
-
-#pragma omp section
+		};
+		for (int i = rowBegin; i < rowEnd; ++i)//逐行扫
 		{
-		for (int i = edgeSize1; i < edgeSize2; ++i)
+			if (blockIndex == NULL)
+			{
+				scanCells(i, 0, dataSize_j);
+				continue;
+			}
+			//只扫描可能包含等值的块，其余块的临时边不初始化也不会被读取
+			int bi = i / blockIndex->blockSize;
+			for (int bj = 0; bj < blockIndex->blockCols; ++bj)
 			{
-				if (edgeArray[i].isovalue != 999)
+				if (blockIndex->hasIsovalue(bi, bj, thresholds))
 				{
-					addPointToLineAccelerate(edgeArray[i].edgeIndex1, edgeArray[i].edgeIndex2, edgeArray[i].i, edgeArray[i].j,
-						data, pathLinesHit1[edgeArray[i].m], edgeArray[i].isovalue, pathLinesV1[edgeArray[i].m],
-						startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
+					int colBegin = bj * blockIndex->blockSize;
+					scanCells(i, colBegin, min(colBegin + blockIndex->blockSize, dataSize_j));
 				}
 			}
 		}
-#pragma omp section
+	};
+	parallelFor(scheduler, 0, dataSize_i, rowGrain, [&generate](int rowBegin, int rowEnd) { generate(rowBegin, rowEnd); }, &tasks);
+
+	if (stats != NULL)
+	{
+		double now = getTimeMs();
+		stats->classifyTime = now - phaseTime;
+		phaseTime = now;
+		stats->cellNum = (long long)dataSize_i * dataSize_j;
+		stats->segmentNum = 0;
+		int rowEdgeCountSize = rowEdgeCount.size();
+		for (int k = 0; k < rowEdgeCountSize; ++k)
+		{
+			stats->segmentNum += rowEdgeCount[k];
+		}
+	}
+
+	//按行划分拼接区域，区域数量随线程数和等值数量变化，而不是固定的4个section
+	vector<int> &bandStart = context.bandStart;
+	int bandNum = getBandStart(dataSize_i, getTaskBandLimit(threadNum, isovaluesNum), bandStart);
+
+	//拼接任务按（区域 × 等值）划分，不同等值的等值线集合互不相关
+	//任务按工作量从大到小提交，线程池先执行大任务，稠密的等值不会拖慢稀疏的等值
+	int cols = dataSize_j + 1;
+	int slotNum = bandNum * isovaluesNum;
+	if ((int)context.bandLines.size() < slotNum)
+	{
+		context.bandLines.resize(slotNum);
+		context.linkBuffers.resize(slotNum);
+	}
+	vector< pair<int, int> > &taskCost = context.taskCost;
+	taskCost.clear();
+	for (int b = 0; b < bandNum; ++b)
+	{
+		for (int m = 0; m < isovaluesNum; ++m)
+		{
+			context.bandLines[b * isovaluesNum + m].clear();
+			int cost = 0;
+			for (int i = bandStart[b]; i < bandStart[b + 1]; ++i)
+			{
+				cost += rowEdgeCount[i * isovaluesNum + m];
+			}
+			if (cost > 0)
+			{
+				taskCost.push_back(make_pair(cost, b * isovaluesNum + m));
+			}
+		}
+	}
+	sort(taskCost.begin(), taskCost.end(), greater< pair<int, int> >());
+
+	auto stitch = [&](int t)
+	{
+		int slot = taskCost[t].second;
+		int b = slot / isovaluesNum;
+		int m = slot % isovaluesNum;
+		EdgeLinkBuffer &buffer = context.linkBuffers[slot];
+		vector<unsigned long long> &pieceIds = buffer.pieceIds;
+		vector<int> &pieceStart = buffer.pieceStart;
+		pieceIds.clear();
+		pieceStart.clear();
+		//没有该等值片段的行，以及块范围不含该等值的块都不扫描
+		for (int i = bandStart[b]; i < bandStart[b + 1]; ++i)
 		{
-			for (int i = edgeSize2; i < edgeSize3; ++i)
+			if (rowEdgeCount[i * isovaluesNum + m] == 0)
 			{
-				if (edgeArray[i].isovalue != 999)
+				continue;
+			}
+			int blockSize = blockIndex != NULL ? blockIndex->blockSize : dataSize_j;
+			for (int colBegin = 0; colBegin < dataSize_j; colBegin += blockSize)
+			{
+				if (blockIndex != NULL)
 				{
-					addPointToLineAccelerate(edgeArray[i].edgeIndex1, edgeArray[i].edgeIndex2, edgeArray[i].i, edgeArray[i].j,
-						data, pathLinesHit2[edgeArray[i].m], edgeArray[i].isovalue, pathLinesV2[edgeArray[i].m],
-						startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
+					int blockPos = i / blockSize * blockIndex->blockCols + colBegin / blockSize;
+					if (thresholds[m] < blockIndex->blockMin[blockPos] || thresholds[m] > blockIndex->blockMax[blockPos])
+					{
+						continue;
+					}
+				}
+				int colEnd = min(colBegin + blockSize, dataSize_j);
+				for (int j = colBegin; j < colEnd; ++j)
+				{
+					int currentIndex = ((i * dataSize_j + j) * isovaluesNum + m) * 2;
+					for (int k = currentIndex; k < currentIndex + 2; ++k)
+					{
+						if (edgeArray[k].m >= 0)
+						{
+							pieceStart.push_back(pieceIds.size());
+							pieceIds.push_back(getEdgeId(edgeArray[k].edgeIndex1, i, j, cols, m));
+							pieceIds.push_back(getEdgeId(edgeArray[k].edgeIndex2, i, j, cols, m));
+						}
+					}
 				}
 			}
 		}
-#pragma omp section
+		pieceStart.push_back(pieceIds.size());
+		linkEdgeIdPieces(pieceIds, pieceStart, context.bandLines[slot], buffer.linkTable);
+	};
+	tasks.clear();
+	int taskCostSize = taskCost.size();
+	for (int t = 0; t < taskCostSize; ++t)
+	{
+		tasks.push_back([&stitch, t]() { stitch(t); });
+	}
+	scheduler->runTasks(tasks);
+	if (stats != NULL)
+	{
+		double now = getTimeMs();
+		stats->stitchTime = now - phaseTime;
+		phaseTime = now;
+	}
+
+	//区域拼接：只有端点落在接缝（区域起始行的水平边）上的等值线需要再次连接，每个等值一个任务
+	vector<char> &isSeamRow = context.isSeamRow;
+	isSeamRow.assign(dataSize_i + 1, 0);
+	for (int b = 1; b < bandNum; ++b)
+	{
+		isSeamRow[bandStart[b]] = 1;
+	}
+	auto isSeamId = [&](unsigned long long id) -> bool
+	{
+		unsigned long long edge = id & ((1ULL << EDGE_ID_LEVEL_SHIFT) - 1);
+		return edge % 2 == 1 && isSeamRow[edge / 2 / cols] != 0;
+	};
+	if ((int)context.levelLines.size() < isovaluesNum)
+	{
+		context.levelLines.resize(isovaluesNum);
+	}
+	auto relink = [&](int m)
+	{
+		EdgeIdLines &levelLines = context.levelLines[m];
+		levelLines.clear();
+		//拼接阶段已经结束，借用第m个拼接任务的临时内存
+		EdgeLinkBuffer &buffer = context.linkBuffers[m];
+		vector<unsigned long long> &pieceIds = buffer.pieceIds;
+		vector<int> &pieceStart = buffer.pieceStart;
+		pieceIds.clear();
+		pieceStart.clear();
+		for (int b = 0; b < bandNum; ++b)
 		{
-			for (int i = edgeSize3; i < edgeSize; ++i)
+			EdgeIdLines &bandLines = context.bandLines[b * isovaluesNum + m];
+			int bandLinesSize = bandLines.size();
+			for (int k = 0; k < bandLinesSize; ++k)
 			{
-				if (edgeArray[i].isovalue != 999)
+				vector<unsigned long long>::iterator first = bandLines.ids.begin() + bandLines.start[k];
+				vector<unsigned long long>::iterator last = bandLines.ids.begin() + bandLines.start[k + 1];
+				if (bandLines.isCircle[k] || (!isSeamId(*first) && !isSeamId(*(last - 1))))
 				{
-					addPointToLineAccelerate(edgeArray[i].edgeIndex1, edgeArray[i].edgeIndex2, edgeArray[i].i, edgeArray[i].j,
-						data, pathLinesHit3[edgeArray[i].m], edgeArray[i].isovalue, pathLinesV3[edgeArray[i].m],
-						startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace);
+					levelLines.ids.insert(levelLines.ids.end(), first, last);
+					levelLines.finishLine(bandLines.isCircle[k] != 0);
+					continue;
 				}
+				pieceStart.push_back(pieceIds.size());
+				pieceIds.insert(pieceIds.end(), first, last);
 			}
 		}
+		pieceStart.push_back(pieceIds.size());
+		linkEdgeIdPieces(pieceIds, pieceStart, levelLines, buffer.linkTable);
+	};
+	tasks.clear();
+	for (int m = 0; m < isovaluesNum; ++m)
+	{
+		tasks.push_back([&relink, m]() { relink(m); });
+	}
+	scheduler->runTasks(tasks);
+	if (context.canonicalOrder)
+	{
+		canonicalizeEdgeIdLines(context, data, isovalues, scheduler);
+	}
+	if (stats != NULL)
+	{
+		double now = getTimeMs();
+		stats->mergeTime = now - phaseTime;
+		phaseTime = now;
+	}
+	if (context.buildNesting)
+	{
+		//在计算坐标之前统一方向，结果的点序即为统一后的方向
+		buildRingTree(context, data, isovalues, scheduler);
 	}
 
-	//区域拼接
-	isMergeTwoArea(dataSize_i / 4, pathLinesV, pathLinesV1, pathLinesTemp);
-	isMergeTwoArea(dataSize_i / 4 * 3, pathLinesV2, pathLinesV3, pathLinesTemp);
-	isMergeTwoArea(dataSize_i / 2, pathLinesV, pathLinesV2, pathLinesTemp);
-
-	int pathLinesV_i = pathLinesV.size();
-	for (int i = 0; i < pathLinesV_i; ++i)
+	//统一计算坐标：所有等值的等值线编号连续排列，按点数均分为多个任务并行插值，
+	//每个任务从自己的结点池中取回收的链表结点，不够时才新申请
+	vector<int> &lineOffset = context.lineOffset;
+	lineOffset.assign(isovaluesNum + 1, 0);
+	for (int m = 0; m < isovaluesNum; ++m)
 	{
-		int pathLinesV_j = pathLinesV[i].size();
-		for (int j = 0; j < pathLinesV_j; ++j)
+		lineOffset[m + 1] = lineOffset[m] + context.levelLines[m].size();
+		pathLinesV[m].resize(context.levelLines[m].size());
+	}
+	int linesNum = lineOffset[isovaluesNum];
+	vector<long long> &pointOffset = context.pointOffset;
+	pointOffset.resize(linesNum + 1);
+	pointOffset[0] = 0;
+	for (int m = 0; m < isovaluesNum; ++m)
+	{
+		EdgeIdLines &levelLines = context.levelLines[m];
+		int levelLinesSize = levelLines.size();
+		for (int k = 0; k < levelLinesSize; ++k)
+		{
+			int n = lineOffset[m] + k;
+			pointOffset[n + 1] = pointOffset[n] + levelLines.start[k + 1] - levelLines.start[k];
+		}
+	}
+	long long pointsNum = pointOffset[linesNum];
+	int chunksNum = threadNum * 4;
+	vector<int> &chunkStart = context.chunkStart;
+	chunkStart.resize(chunksNum + 1);
+	for (int c = 0; c < chunksNum; ++c)
+	{
+		chunkStart[c] = lower_bound(pointOffset.begin(), pointOffset.begin() + linesNum, pointsNum * c / chunksNum) - pointOffset.begin();
+	}
+	chunkStart[chunksNum] = linesNum;
+	distributeNodes(context, chunksNum);
+	IsolineIndex &index = context.index;
+	if (context.buildIndex)
+	{
+		//每条等值线的段数由点数确定，各任务直接写入自己的位置
+		index.lineBoxes.resize(isovaluesNum);
+		for (int m = 0; m < isovaluesNum; ++m)
+		{
+			index.lineBoxes[m].resize(context.levelLines[m].size());
+		}
+		index.chunkOffset.resize(linesNum + 1);
+		index.chunkOffset[0] = 0;
+		for (int n = 0; n < linesNum; ++n)
+		{
+			index.chunkOffset[n + 1] = index.chunkOffset[n] + getIsolineChunkNum(pointOffset[n + 1] - pointOffset[n]);
+		}
+		index.chunks.resize(index.chunkOffset[linesNum]);
+	}
+	//插值方式（是否吸附到格点、是否曲线网格）每条等值线选择一次，插值时不再判断
+	int pointMode = (options == NULL || options->snapToNode ? 2 : 0) | (table.nodeX != NULL ? 1 : 0);
+	auto materialize = [&](int c)
+	{
+		int lineBegin = chunkStart[c];
+		int lineEnd = chunkStart[c + 1];
+		list<isotools::Point2D> &pool = context.nodePools[c];
+		int m = upper_bound(lineOffset.begin(), lineOffset.end(), lineBegin) - lineOffset.begin() - 1;
+		for (int n = lineBegin; n < lineEnd; ++n)
 		{
-			if (abs(pathLinesV[i][j].startPoint.x - pathLinesV[i][j].endPoint.x) <= 0.5 && abs(pathLinesV[i][j].startPoint.y - pathLinesV[i][j].endPoint.y) <= 0.5)
+			while (n >= lineOffset[m + 1])
 			{
-				//近似首尾相连
-				pathLinesV[i][j].isCircle = true;
-				pathLinesV[i][j].endPoint = pathLinesV[i][j].startPoint;
+				++m;
+			}
+			EdgeIdLines &levelLines = context.levelLines[m];
+			int k = n - lineOffset[m];
+			int first = levelLines.start[k], last = levelLines.start[k + 1];
+			isotools::Isoline &isoline = pathLinesV[m][k];
+			isoline.isovalue = isovalues[m];
+			isoline.isCircle = levelLines.isCircle[k] != 0;
+			isoline.isBorder = false;
+			isoline.points.clear();
+			isotools::resetIsolineMetrics(isoline);
+
+			switch (pointMode)
+			{
+			case 0:
+				fillEdgeIdPoints<false, false>(levelLines, first, last, data, isovalues[m], table, isoline, pool);
+				break;
+			case 1:
+				fillEdgeIdPoints<false, true>(levelLines, first, last, data, isovalues[m], table, isoline, pool);
+				break;
+			case 2:
+				fillEdgeIdPoints<true, false>(levelLines, first, last, data, isovalues[m], table, isoline, pool);
+				break;
+			default:
+				fillEdgeIdPoints<true, true>(levelLines, first, last, data, isovalues[m], table, isoline, pool);
+				break;
+			}
+			isoline.startPoint = getEdgeIdMiddlePoint(levelLines.ids[first], cols);
+			isoline.endPoint = isoline.isCircle ? isoline.startPoint : getEdgeIdMiddlePoint(levelLines.ids[last - 1], cols);
+			if (context.buildIndex)
+			{
+				addIsolineChunks(isoline, m, k, &index.chunks[index.chunkOffset[n]], index.lineBoxes[m][k]);
 			}
 		}
+	};
+	tasks.clear();
+	for (int c = 0; c < chunksNum; ++c)
+	{
+		tasks.push_back([&materialize, c]() { materialize(c); });
+	}
+	scheduler->runTasks(tasks);
+	if (context.buildIndex)
+	{
+		packIsolineIndex(index, scheduler);
+	}
+
+	finishIsolines(data, pathLinesV, options, false);
+	if (stats != NULL)
+	{
+		stats->finishTime = getTimeMs() - phaseTime;
+		stats->outputNum = 0;
+		for (int m = 0; m < isovaluesNum; ++m)
+		{
+			stats->outputNum += pathLinesV[m].size();
+		}
 	}
+	return pathLinesV;
+}
 
-	delete[] edgeArray;
+/************************************************************************/
+/* Funciton: doMarchingSquaresAccelerateTask 【此方法适用于 多核CPU，运行在可插拔的任务调度器上】
+ * Description: 使用临时的上下文调用上面的版本，结果转移到pathLinesV
+ * Input:
+	data: 天气数据值二维数组
+	isovalues: 等值线值数组
+	pathLinesV: 返回该等值数组下的所有各条等值线数组的集合
+	startLongitude: 起始经度（起始x坐标）
+	longitudeGridSpace: 经度间隔（x坐标间隔）
+	startLatitude: 起始纬度（起始y坐标）
+	latitudeGridSpace: 纬度间隔（y坐标间隔）
+	maxGridValue: 网格点中的最大值
+	minGridValue: 网格点中的最小值
+	scheduler: 任务调度器，为NULL时使用默认的work-stealing线程池
+	options: 缺测值、格点坐标等可选设置，为NULL时不判断缺测并使用规则网格
+* Output: void
+* Author: gcdofree
+* Date: 2026.10.19
+/************************************************************************/
+static void doMarchingSquaresAccelerateTask(vector<vector<float> > &data, vector<float> &isovalues, vector< vector<isotools::Isoline>> &pathLinesV,
+	float startLongitude, float longitudeGridSpace, float startLatitude, float latitudeGridSpace, float maxGridValue, float minGridValue,
+	TaskScheduler *scheduler = NULL, const ContourOptions *options = NULL)
+{
+	ContourContext context;
+	doMarchingSquaresAccelerateTask(context, data, isovalues, startLongitude, longitudeGridSpace, startLatitude, latitudeGridSpace,
+		maxGridValue, minGridValue, scheduler, options);
+	pathLinesV.swap(context.pathLinesV);
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,388 @@
+﻿#pragma once
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+using namespace std;
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: 可插拔的任务调度接口，以及默认的work-stealing线程池
+ *	并行等值线驱动只依赖TaskScheduler接口，可以替换为业务方已有的线程池；
+ *	多个并发请求共享同一个线程池，细粒度任务交错执行，避免多个OpenMP并行区同时运行导致的超额订阅
+/************************************************************************/
+namespace marchingsquares
+{
+
+/**  任务调度接口 **/
+class TaskScheduler
+{
+public:
+	virtual ~TaskScheduler() {}
+
+	/* 返回参与计算的线程数（用于确定任务划分的粒度） */
+	virtual int getThreadNum() const = 0;
+
+	/* 执行一组相互独立的任务，全部完成后返回
+	* 允许在任务内部嵌套调用，也允许多个线程同时调用
+	* 任务抛出异常时其余任务照常执行，全部完成后在调用线程重新抛出第一个异常
+	*/
+	virtual void runTasks(vector< function<void()> > &tasks) = 0;
+};
+
+/**  work-stealing线程池：每个工作线程有自己的双端队列，本线程从尾部取任务，空闲线程从其他队列头部窃取 **/
+class WorkStealingPool : public TaskScheduler
+{
+public:
+	/* threadNum为工作线程数，小于等于0时取硬件线程数 */
+	explicit WorkStealingPool(int threadNum = 0)
+		: stopFlag(false), queuedNum(0)
+	{
+		if (threadNum <= 0)
+		{
+			threadNum = (int)thread::hardware_concurrency();
+			if (threadNum <= 0)
+				threadNum = 1;
+		}
+		//最后一个队列是外部线程提交任务用的注入队列
+		queues.resize(threadNum + 1);
+		for (int i = 0; i <= threadNum; ++i)
+		{
+			queues[i] = new WorkerQueue();
+		}
+		for (int i = 0; i < threadNum; ++i)
+		{
+			workers.push_back(thread(&WorkStealingPool::workerLoop, this, i));
+		}
+	}
+
+	~WorkStealingPool()
+	{
+		{
+			lock_guard<mutex> guard(sleepLock);
+			stopFlag = true;
+		}
+		sleepCond.notify_all();
+		int workersNum = workers.size();
+		for (int i = 0; i < workersNum; ++i)
+		{
+			workers[i].join();
+		}
+		int queuesNum = queues.size();
+		for (int i = 0; i < queuesNum; ++i)
+		{
+			delete queues[i];
+		}
+	}
+
+	int getThreadNum() const
+	{
+		return workers.size();
+	}
+
+	void runTasks(vector< function<void()> > &tasks)
+	{
+		int tasksNum = tasks.size();
+		if (tasksNum == 0)
+		{
+			return;
+		}
+		if (tasksNum == 1)
+		{
+			tasks[0]();
+			return;
+		}
+
+		TaskGroup group;
+		group.pending = tasksNum;
+
+		//工作线程内提交的任务放入自己的队列，外部线程提交的任务放入注入队列
+		int selfIndex = getWorkerIndex();
+		WorkerQueue *queue = queues[selfIndex >= 0 ? selfIndex : queues.size() - 1];
+		{
+			lock_guard<mutex> guard(queue->lock);
+			for (int i = 0; i < tasksNum; ++i)
+			{
+				TaskItem item;
+				item.func = &tasks[i];
+				item.group = &group;
+				queue->tasks.push_back(item);
+			}
+		}
+		{
+			lock_guard<mutex> guard(sleepLock);
+			queuedNum += tasksNum;
+		}
+		sleepCond.notify_all();
+
+		//等待期间当前线程也参与执行任务，保证嵌套调用不会死锁
+		while (group.pending.load() > 0)
+		{
+			TaskItem item;
+			if (popTask(selfIndex, item))
+			{
+				executeTask(item);
+				continue;
+			}
+			unique_lock<mutex> guard(sleepLock);
+			sleepCond.wait(guard, [&]() { return group.pending.load() == 0 || queuedNum.load() > 0; });
+		}
+		//所有任务都已结束，不再有线程引用group和tasks，此时才能把异常抛给调用者
+		if (group.error)
+		{
+			rethrow_exception(group.error);
+		}
+	}
+
+private:
+	struct TaskGroup
+	{
+		atomic<int> pending;//尚未完成的任务数
+		mutex errorLock;
+		exception_ptr error;//第一个抛出的异常，由runTasks在全部任务结束后重新抛出
+	};
+
+	struct TaskItem
+	{
+		function<void()> *func;
+		TaskGroup *group;
+	};
+
+	struct WorkerQueue
+	{
+		mutex lock;
+		deque<TaskItem> tasks;
+	};
+
+	vector<thread> workers;
+	vector<WorkerQueue *> queues;
+	mutex sleepLock;
+	condition_variable sleepCond;
+	bool stopFlag;
+	atomic<int> queuedNum;//所有队列中等待执行的任务总数
+
+	/* 当前线程在本线程池中的编号，非本线程池的线程返回-1 */
+	int getWorkerIndex()
+	{
+		WorkerIdentity &identity = getIdentity();
+		return identity.pool == this ? identity.index : -1;
+	}
+
+	struct WorkerIdentity
+	{
+		WorkStealingPool *pool;
+		int index;
+	};
+
+	static WorkerIdentity &getIdentity()
+	{
+		static thread_local WorkerIdentity identity = { NULL, -1 };
+		return identity;
+	}
+
+	/* 取一个任务：先取自己队列的尾部，再窃取其他队列的头部，最后取注入队列 */
+	bool popTask(int selfIndex, TaskItem &item)
+	{
+		if (queuedNum.load() <= 0)
+		{
+			return false;
+		}
+		int queuesNum = queues.size();
+		if (selfIndex >= 0)
+		{
+			WorkerQueue *queue = queues[selfIndex];
+			lock_guard<mutex> guard(queue->lock);
+			if (!queue->tasks.empty())
+			{
+				item = queue->tasks.back();
+				queue->tasks.pop_back();
+				--queuedNum;
+				return true;
+			}
+		}
+		int start = selfIndex >= 0 ? selfIndex + 1 : 0;
+		for (int k = 0; k < queuesNum; ++k)
+		{
+			int victim = (start + k) % queuesNum;
+			if (victim == selfIndex)
+				continue;
+			WorkerQueue *queue = queues[victim];
+			lock_guard<mutex> guard(queue->lock);
+			if (!queue->tasks.empty())
+			{
+				item = queue->tasks.front();
+				queue->tasks.pop_front();
+				--queuedNum;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void executeTask(TaskItem &item)
+	{
+		//异常不能离开工作线程（否则terminate），记录下来后照常减少计数
+		try
+		{
+			(*item.func)();
+		}
+		catch (...)
+		{
+			lock_guard<mutex> guard(item.group->errorLock);
+			if (!item.group->error)
+			{
+				item.group->error = current_exception();
+			}
+		}
+		if (--item.group->pending == 0)
+		{
+			//在锁内通知，避免等待线程错过唤醒
+			lock_guard<mutex> guard(sleepLock);
+			sleepCond.notify_all();
+		}
+	}
+
+	void workerLoop(int index)
+	{
+		WorkerIdentity &identity = getIdentity();
+		identity.pool = this;
+		identity.index = index;
+		while (true)
+		{
+			TaskItem item;
+			if (popTask(index, item))
+			{
+				executeTask(item);
+				continue;
+			}
+			unique_lock<mutex> guard(sleepLock);
+			sleepCond.wait(guard, [&]() { return stopFlag || queuedNum.load() > 0; });
+			if (stopFlag && queuedNum.load() <= 0)
+			{
+				return;
+			}
+		}
+	}
+};
+
+/************************************************************************/
+/* Funciton: getDefaultScheduler
+ * Description: 获得进程内共享的默认线程池（首次调用时创建）
+ * Output: TaskScheduler指针
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+inline TaskScheduler *getDefaultScheduler()
+{
+	static WorkStealingPool pool;
+	return &pool;
+}
+
+/************************************************************************/
+/* Funciton: parallelFor
+ * Description: 将[begin, end)按grain大小切块，作为一组任务提交给调度器
+ * Input:
+	scheduler: 任务调度器，为NULL时使用默认线程池
+	begin: 起始下标
+	end: 结束下标（不含）
+	grain: 每个任务处理的下标数量
+	func: 处理[blockBegin, blockEnd)的函数
+	taskBuffer: 可选的任务数组，由调用者保留以便重复使用内存，为NULL时使用局部变量
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+static void parallelFor(TaskScheduler *scheduler, int begin, int end, int grain, const function<void(int, int)> &func,
+	vector< function<void()> > *taskBuffer = NULL)
+{
+	if (end <= begin)
+	{
+		return;
+	}
+	if (scheduler == NULL)
+	{
+		scheduler = getDefaultScheduler();
+	}
+	if (grain < 1)
+	{
+		grain = 1;
+	}
+	vector< function<void()> > localTasks;
+	vector< function<void()> > &tasks = taskBuffer != NULL ? *taskBuffer : localTasks;
+	tasks.clear();
+	for (int blockBegin = begin; blockBegin < end; blockBegin += grain)
+	{
+		int blockEnd = blockBegin + grain < end ? blockBegin + grain : end;
+		tasks.push_back([&func, blockBegin, blockEnd]() { func(blockBegin, blockEnd); });
+	}
+	scheduler->runTasks(tasks);
+}
+
+/************************************************************************/
+/* Funciton: parallelSort
+ * Description: 并行稳定排序：先把数组均分为若干块各自稳定排序，再逐轮两两归并（每轮的归并并行执行）；
+ *	块内与归并都是稳定的，结果与stable_sort完全相同，与线程数和分块方式无关
+ * Input:
+	scheduler: 任务调度器，为NULL时使用默认线程池
+	values: 待排序的数组，结果直接写回
+	buffer: 归并用的临时数组，由调用者保留以便重复使用内存
+	comp: 比较函数
+ * Output: void
+ * Author: gcdofree
+ * Date: 2026.10.19
+/************************************************************************/
+template<class T, class Compare>
+static void parallelSort(TaskScheduler *scheduler, vector<T> &values, vector<T> &buffer, Compare comp)
+{
+	const int SORT_MIN_BLOCK = 4096;//每块的最少元素数，块太小时并行的开销大于收益
+	if (scheduler == NULL)
+	{
+		scheduler = getDefaultScheduler();
+	}
+	int valuesNum = values.size();
+	int blocksNum = min(scheduler->getThreadNum(), valuesNum / SORT_MIN_BLOCK);
+	if (blocksNum <= 1)
+	{
+		stable_sort(values.begin(), values.end(), comp);
+		return;
+	}
+	vector<int> blockStart(blocksNum + 1);
+	for (int b = 0; b <= blocksNum; ++b)
+	{
+		blockStart[b] = (int)((long long)valuesNum * b / blocksNum);
+	}
+	parallelFor(scheduler, 0, blocksNum, 1, [&](int blockBegin, int blockEnd)
+	{
+		for (int b = blockBegin; b < blockEnd; ++b)
+		{
+			stable_sort(values.begin() + blockStart[b], values.begin() + blockStart[b + 1], comp);
+		}
+	});
+
+	//每轮把相邻的两块归并为一块，落单的最后一块直接复制
+	buffer.resize(valuesNum);
+	for (int width = 1; width < blocksNum; width *= 2)
+	{
+		int pairsNum = (blocksNum + width * 2 - 1) / (width * 2);
+		parallelFor(scheduler, 0, pairsNum, 1, [&](int pairBegin, int pairEnd)
+		{
+			for (int p = pairBegin; p < pairEnd; ++p)
+			{
+				int first = blockStart[p * width * 2];
+				int middle = blockStart[min(p * width * 2 + width, blocksNum)];
+				int last = blockStart[min(p * width * 2 + width * 2, blocksNum)];
+				merge(values.begin() + first, values.begin() + middle, values.begin() + middle, values.begin() + last,
+					buffer.begin() + first, comp);
+			}
+		});
+		values.swap(buffer);
+	}
+}
+
+}
@@ -0,0 +1,81 @@
+#include "../MarchingCubes.h"
+#include <cstdio>
+#include <map>
+#include <random>
+
+using namespace std;
+using namespace marchingcubes;
+
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: Marching Cubes 网格的检查程序：随机体数据（含大量二义性的面）生成的网格必须是有向流形，
+ *	每条有向边最多被一个三角形使用，不在体数据边界面上的有向边必须有反向的边与之配对
+ * 用法: g++ -std=c++11 -O2 -pthread MarchingCubesTest.cpp -o MarchingCubesTest && ./MarchingCubesTest
+/************************************************************************/
+
+/* 两个顶点在同一个体数据边界面上时，它们之间的边可以只被一个三角形使用 */
+static bool isBorderEdge(const isotools::Point3D &a, const isotools::Point3D &b, const VolumeView &volume)
+{
+	return (a.x == 0 && b.x == 0) || (a.x == volume.nx - 1 && b.x == volume.nx - 1) ||
+		(a.y == 0 && b.y == 0) || (a.y == volume.ny - 1 && b.y == volume.ny - 1) ||
+		(a.z == 0 && b.z == 0) || (a.z == volume.nz - 1 && b.z == volume.nz - 1);
+}
+
+static bool checkVolume(const char *name, int nx, int ny, int nz, bool isBinary, unsigned int seed, int threadNum)
+{
+	vector<float> data(nx * ny * nz);
+	mt19937 random(seed);
+	for (size_t k = 0; k < data.size(); ++k)
+	{
+		data[k] = isBinary ? ((random() & 1) != 0 ? 1.0f : -1.0f) : (float)(random() % 1000) / 1000 - 0.5f;
+	}
+	VolumeView volume;
+	volume.data = data.data();
+	volume.nx = nx;
+	volume.ny = ny;
+	volume.nz = nz;
+
+	marchingsquares::WorkStealingPool pool(threadNum);
+	vector<float> isovalues(1, 0.0f);
+	vector<isotools::TriangleMesh> meshes;
+	doMarchingCubes(volume, isovalues, meshes, 1, -1, &pool);
+	const isotools::TriangleMesh &mesh = meshes[0];
+
+	map< pair<int, int>, int > edgeUse;
+	for (size_t k = 0; k + 2 < mesh.indices.size(); k += 3)
+	{
+		for (int t = 0; t < 3; ++t)
+		{
+			++edgeUse[make_pair(mesh.indices[k + t], mesh.indices[k + (t + 1) % 3])];
+		}
+	}
+	int repeatedNum = 0, unpairedNum = 0;
+	for (map< pair<int, int>, int >::const_iterator it = edgeUse.begin(); it != edgeUse.end(); ++it)
+	{
+		repeatedNum += it->second > 1 ? 1 : 0;
+		if (edgeUse.find(make_pair(it->first.second, it->first.first)) == edgeUse.end() &&
+			!isBorderEdge(mesh.vertices[it->first.first], mesh.vertices[it->first.second], volume))
+		{
+			++unpairedNum;
+		}
+	}
+	bool isPassed = !mesh.indices.empty() && repeatedNum == 0 && unpairedNum == 0;
+	printf("%s %dx%dx%d, %d threads: %d triangles, repeated directed edges %d, unpaired edges %d: %s\n", name, nx, ny, nz, threadNum,
+		(int)mesh.indices.size() / 3, repeatedNum, unpairedNum, isPassed ? "ok" : "FAILED");
+	return isPassed;
+}
+
+int main()
+{
+	bool isPassed = true;
+	for (unsigned int seed = 1; seed <= 3; ++seed)
+	{
+		isPassed = checkVolume("random", 37, 29, 41, false, seed, 4) && isPassed;
+		isPassed = checkVolume("binary", 37, 29, 41, true, seed, 4) && isPassed;
+		isPassed = checkVolume("random", 5, 4, 6, false, seed, 1) && isPassed;
+		isPassed = checkVolume("binary", 5, 4, 6, true, seed, 1) && isPassed;
+	}
+	printf(isPassed ? "PASSED\n" : "FAILED\n");
+	return isPassed ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+#include "../ContourPartition.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace marchingsquares;
+
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: 分区生成等值线的检查程序：每个分区启动一个独立的工作进程（重新运行本程序），
+ *	工作进程只取自己分区的格点，用contourPartition生成结果并写入接缝文件；
+ *	协调进程读取各接缝文件并合并，与整个网格一次生成的结果逐条比较（等值线顺序、方向和环的起点不计）
+ * 用法: PartitionTest [分区数] [接缝文件前缀]
+ *	g++ -std=c++11 -O2 -pthread PartitionTest.cpp -o PartitionTest && ./PartitionTest 4
+/************************************************************************/
+
+typedef vector< pair<float, float> > PointList;
+
+/* 生成测试网格，工作进程和协调进程各自生成相同的数据；withMissing为true时加入缺测区域，并让缺测跨过接缝 */
+static void makeGrid(int rows, int cols, bool withMissing, vector< vector<float> > &data)
+{
+	data.assign(rows, vector<float>(cols));
+	for (int i = 0; i < rows; ++i)
+	{
+		for (int j = 0; j < cols; ++j)
+		{
+			data[i][j] = sinf(i * 0.031f) * cosf(j * 0.027f) * 10 + 3 * sinf(i * 0.17f + j * 0.11f) + 2 * cosf(i * 0.05f - j * 0.19f);
+			if (withMissing && ((i - 180) * (i - 180) + (j - 85) * (j - 85) < 900 || (i % 61 == 0 && j % 7 == 0)))
+			{
+				data[i][j] = NAN;
+			}
+		}
+	}
+}
+
+static void getGridRange(const vector< vector<float> > &data, float &maxValue, float &minValue)
+{
+	maxValue = -FLT_MAX;
+	minValue = FLT_MAX;
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		for (size_t j = 0; j < data[i].size(); ++j)
+		{
+			if (data[i][j] == data[i][j])
+			{
+				maxValue = max(maxValue, data[i][j]);
+				minValue = min(minValue, data[i][j]);
+			}
+		}
+	}
+}
+
+static const int GRID_ROWS = 613;
+static const int GRID_COLS = 401;
+static const float START_X = 2, DX = 0.5f, START_Y = 60, DY = -0.25f;
+
+static void getIsovalues(vector<float> &isovalues)
+{
+	isovalues.clear();
+	for (float value = -13; value <= 13; value += 1.1f)
+	{
+		isovalues.push_back(value);
+	}
+}
+
+static string getPartitionPath(const string &prefix, int part)
+{
+	char name[32];
+	sprintf(name, "_%d.bin", part);
+	return prefix + name;
+}
+
+/* 工作进程：生成第part个分区的结果并写入接缝文件 */
+static int runWorker(int part, int partNum, bool withMissing, const string &prefix)
+{
+	vector< vector<float> > data;
+	makeGrid(GRID_ROWS, GRID_COLS, withMissing, data);
+	float maxValue, minValue;
+	getGridRange(data, maxValue, minValue);
+	vector<int> partStart;
+	if (part >= getPartitionStart(GRID_ROWS, partNum, partStart))
+	{
+		return 1;
+	}
+	//只保留自己分区的格点（与下一个分区共用最后一行）
+	vector< vector<float> > band(data.begin() + partStart[part], data.begin() + partStart[part + 1] + 1);
+	data.clear();
+
+	vector<float> isovalues;
+	getIsovalues(isovalues);
+	ContourOptions options;
+	ContourContext context;
+	PartitionResult result;
+	contourPartition(context, band, partStart[part], GRID_ROWS, isovalues, START_X, DX, START_Y, DY, maxValue, minValue, result,
+		NULL, withMissing ? &options : NULL);
+	return writePartitionFile(getPartitionPath(prefix, part).c_str(), result) ? 0 : 1;
+}
+
+/* 等值线的规范形式：开放的线取两个方向中字典序较小的一个，环再取字典序最小的起点 */
+static PointList getCanonicalPoints(const isotools::Isoline &line)
+{
+	PointList points;
+	for (list<isotools::Point2D>::const_iterator it = line.points.begin(); it != line.points.end(); ++it)
+	{
+		points.push_back(make_pair(it->x, it->y));
+	}
+	PointList reversed(points.rbegin(), points.rend());
+	if (!line.isCircle)
+	{
+		return reversed < points ? reversed : points;
+	}
+	PointList best = points;
+	for (int dir = 0; dir < 2; ++dir)
+	{
+		const PointList &ring = dir == 0 ? points : reversed;
+		for (size_t r = 1; r < ring.size(); ++r)
+		{
+			PointList rotated(ring.begin() + r, ring.end());
+			rotated.insert(rotated.end(), ring.begin(), ring.begin() + r);
+			if (rotated < best)
+			{
+				best = rotated;
+			}
+		}
+		if (dir == 0 && reversed < best)
+		{
+			best = reversed;
+		}
+	}
+	return best;
+}
+
+static void getCanonicalLines(const vector<float> &isovalues, const vector< vector<isotools::Isoline>> &pathLinesV,
+	vector< pair<float, pair<int, PointList> > > &lines)
+{
+	lines.clear();
+	for (size_t m = 0; m < pathLinesV.size(); ++m)
+	{
+		for (size_t k = 0; k < pathLinesV[m].size(); ++k)
+		{
+			const isotools::Isoline &line = pathLinesV[m][k];
+			int flags = (line.isCircle ? 1 : 0) | (line.isBorder ? 2 : 0);
+			lines.push_back(make_pair(isovalues[m], make_pair(flags, getCanonicalPoints(line))));
+		}
+	}
+	sort(lines.begin(), lines.end());
+}
+
+/* 协调进程：启动各工作进程，合并接缝文件并与一次生成的结果比较 */
+static bool runCoordinator(const string &program, int partNum, bool withMissing, const string &prefix)
+{
+	vector<int> partStart;
+	int parts = getPartitionStart(GRID_ROWS, partNum, partStart);
+	vector<int> exitCodes(parts, -1);
+	vector<thread> workers;
+	for (int p = 0; p < parts; ++p)
+	{
+		workers.push_back(thread([&, p]()
+		{
+			char args[64];
+			sprintf(args, " worker %d %d %d ", p, partNum, withMissing ? 1 : 0);
+			exitCodes[p] = system(("\"" + program + "\"" + args + "\"" + prefix + "\"").c_str());
+		}));
+	}
+	for (int p = 0; p < parts; ++p)
+	{
+		workers[p].join();
+	}
+
+	vector<PartitionResult> results(parts);
+	for (int p = 0; p < parts; ++p)
+	{
+		string path = getPartitionPath(prefix, p);
+		bool isRead = exitCodes[p] == 0 && readPartitionFile(path.c_str(), results[p]);
+		remove(path.c_str());
+		if (!isRead)
+		{
+			printf("partition %d failed (exit code %d)\n", p, exitCodes[p]);
+			return false;
+		}
+	}
+	vector<float> mergedIsovalues;
+	vector< vector<isotools::Isoline>> merged;
+	if (!mergePartitions(results, mergedIsovalues, merged))
+	{
+		printf("mergePartitions rejected the partitions\n");
+		return false;
+	}
+
+	vector< vector<float> > data;
+	makeGrid(GRID_ROWS, GRID_COLS, withMissing, data);
+	float maxValue, minValue;
+	getGridRange(data, maxValue, minValue);
+	vector<float> isovalues;
+	getIsovalues(isovalues);
+	ContourOptions options;
+	vector< vector<isotools::Isoline>> single;
+	doMarchingSquaresAccelerateTask(data, isovalues, single, START_X, DX, START_Y, DY, maxValue, minValue, NULL, withMissing ? &options : NULL);
+
+	vector< pair<float, pair<int, PointList> > > mergedLines, singleLines;
+	getCanonicalLines(mergedIsovalues, merged, mergedLines);
+	getCanonicalLines(isovalues, single, singleLines);
+	bool isEqual = mergedLines == singleLines;
+	printf("parts %d missing %d: merged %d lines, single %d lines, %s\n", parts, withMissing ? 1 : 0,
+		(int)mergedLines.size(), (int)singleLines.size(), isEqual ? "equal" : "DIFFERENT");
+	return isEqual;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc == 6 && string(argv[1]) == "worker")
+	{
+		return runWorker(atoi(argv[2]), atoi(argv[3]), atoi(argv[4]) != 0, argv[5]);
+	}
+	int partNum = argc > 1 ? atoi(argv[1]) : 4;
+	string prefix = argc > 2 ? argv[2] : "partition_test";
+
+	bool isPassed = true;
+	for (int withMissing = 0; withMissing < 2; ++withMissing)
+	{
+		isPassed = runCoordinator(argv[0], partNum, withMissing != 0, prefix) && isPassed;
+	}
+
+	//截断的接缝数据必须被拒绝，不能按损坏的数量分配内存
+	vector< vector<float> > data;
+	makeGrid(41, GRID_COLS, false, data);
+	vector<float> isovalues(1, 0.0f);
+	ContourContext context;
+	PartitionResult result, restored;
+	contourPartition(context, data, 0, GRID_ROWS, isovalues, START_X, DX, START_Y, DY, 20, -20, result);
+	vector<char> buffer;
+	writePartition(result, buffer);
+	int acceptedNum = 0;
+	for (size_t size = 0; size < buffer.size(); ++size)
+	{
+		acceptedNum += readPartition(buffer.data(), size, restored) ? 1 : 0;
+	}
+	bool isReadBack = readPartition(buffer.data(), buffer.size(), restored);
+	printf("truncated buffers accepted: %d, full buffer read: %d\n", acceptedNum, isReadBack ? 1 : 0);
+	isPassed = isPassed && acceptedNum == 0 && isReadBack;
+
+	//每行格点数不同的分区不能合并
+	vector<PartitionResult> mismatched(2, result);
+	mismatched[1].cols = GRID_COLS + 1;
+	vector< vector<isotools::Isoline>> pathLinesV;
+	if (mergePartitions(mismatched, isovalues, pathLinesV))
+	{
+		printf("mergePartitions accepted mismatched column counts\n");
+		isPassed = false;
+	}
+
+	printf(isPassed ? "PASSED\n" : "FAILED\n");
+	return isPassed ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+#include "../MarchingSquares.h"
+#include <cstdio>
+
+using namespace std;
+using namespace marchingsquares;
+
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: 任务并行版本输出的回归检查，比较结果的逐位哈希（点坐标、首尾端点、标志、长度和叉积）：
+ *	1. 规范顺序输出在不同线程数下逐位相同（含统一方向和环的包含关系树）
+ *	2. int16、uint16、float16、float压缩存储的格点与先还原为float的格点结果逐位相同
+ *	3. 按等值数量特化的分类函数与运行时循环的通用函数结果逐位相同
+ * 用法: g++ -std=c++11 -O2 -pthread ReproducibilityTest.cpp -o ReproducibilityTest && ./ReproducibilityTest
+/************************************************************************/
+
+static unsigned long long hashBytes(unsigned long long hash, const void *bytes, size_t size)
+{
+	const unsigned char *p = (const unsigned char *)bytes;
+	for (size_t k = 0; k < size; ++k)
+	{
+		hash ^= p[k];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static unsigned long long hashLevel(unsigned long long hash, const vector<isotools::Isoline> &lines)
+{
+	size_t linesNum = lines.size();
+	hash = hashBytes(hash, &linesNum, sizeof(linesNum));
+	for (size_t k = 0; k < linesNum; ++k)
+	{
+		const isotools::Isoline &line = lines[k];
+		hash = hashBytes(hash, &line.isCircle, sizeof(line.isCircle));
+		hash = hashBytes(hash, &line.isBorder, sizeof(line.isBorder));
+		hash = hashBytes(hash, &line.startPoint, sizeof(line.startPoint));
+		hash = hashBytes(hash, &line.endPoint, sizeof(line.endPoint));
+		hash = hashBytes(hash, &line.length, sizeof(line.length));
+		hash = hashBytes(hash, &line.crossSum, sizeof(line.crossSum));
+		for (list<isotools::Point2D>::const_iterator it = line.points.begin(); it != line.points.end(); ++it)
+		{
+			hash = hashBytes(hash, &*it, sizeof(*it));
+		}
+	}
+	return hash;
+}
+
+static unsigned long long hashContour(const ContourContext &context)
+{
+	unsigned long long hash = 1469598103934665603ULL;
+	for (size_t m = 0; m < context.pathLinesV.size(); ++m)
+	{
+		hash = hashLevel(hash, context.pathLinesV[m]);
+	}
+	if (context.buildNesting)
+	{
+		hash = hashBytes(hash, context.ringTree.parent.data(), context.ringTree.parent.size() * sizeof(int));
+		hash = hashBytes(hash, context.ringTree.children.data(), context.ringTree.children.size() * sizeof(int));
+	}
+	return hash;
+}
+
+static void makeGrid(int rows, int cols, vector< vector<float> > &data)
+{
+	data.assign(rows, vector<float>(cols));
+	for (int i = 0; i < rows; ++i)
+	{
+		for (int j = 0; j < cols; ++j)
+		{
+			data[i][j] = sinf(i * 0.031f) * cosf(j * 0.027f) * 10 + 3 * sinf(i * 0.17f + j * 0.11f) + 2 * cosf(i * 0.05f - j * 0.19f);
+		}
+	}
+}
+
+static void getGridRange(const vector< vector<float> > &data, float &maxValue, float &minValue)
+{
+	maxValue = -FLT_MAX;
+	minValue = FLT_MAX;
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		for (size_t j = 0; j < data[i].size(); ++j)
+		{
+			maxValue = max(maxValue, data[i][j]);
+			minValue = min(minValue, data[i][j]);
+		}
+	}
+}
+
+static void getIsovalues(float low, float high, float step, vector<float> &isovalues)
+{
+	isovalues.clear();
+	for (float value = low; value <= high; value += step)
+	{
+		isovalues.push_back(value);
+	}
+}
+
+/* 规范顺序的结果在1到8个线程下必须相同 */
+static bool checkThreadCounts(const vector< vector<float> > &data)
+{
+	float maxValue, minValue;
+	getGridRange(data, maxValue, minValue);
+	bool isPassed = true;
+	for (int nesting = 0; nesting < 2; ++nesting)
+	{
+		unsigned long long expected = 0;
+		printf("canonical order, nesting %d:", nesting);
+		for (int threadNum = 1; threadNum <= 8; ++threadNum)
+		{
+			WorkStealingPool pool(threadNum);
+			ContourContext context;
+			context.canonicalOrder = true;
+			context.buildNesting = nesting != 0;
+			vector<float> isovalues;
+			getIsovalues(-13, 13, 0.7f, isovalues);
+			doMarchingSquaresAccelerateTask(context, data, isovalues, 0, 1, 0, 1, maxValue, minValue, &pool);
+			unsigned long long hash = hashContour(context);
+			//同一个上下文再算一次，复用的内存不能影响结果
+			doMarchingSquaresAccelerateTask(context, data, isovalues, 0, 1, 0, 1, maxValue, minValue, &pool);
+			if (threadNum == 1)
+			{
+				expected = hash;
+			}
+			bool isEqual = hash == expected && hashContour(context) == hash;
+			printf(" %d:%s", threadNum, isEqual ? "ok" : "DIFFERENT");
+			isPassed = isPassed && isEqual;
+		}
+		printf("\n");
+	}
+	return isPassed;
+}
+
+/* 压缩存储的格点与先还原为float的格点比较；等值取在存储值上，检查相等时的判断 */
+template<class T>
+static bool checkStorage(const char *name, const vector<T> &values, int rows, int cols, float scale, float offset)
+{
+	GridView<T> grid(values.data(), rows, cols, scale, offset);
+	vector< vector<float> > expanded(rows, vector<float>(cols));
+	for (int i = 0; i < rows; ++i)
+	{
+		for (int j = 0; j < cols; ++j)
+		{
+			expanded[i][j] = getGridValue(grid, i, j);
+		}
+	}
+	float maxValue, minValue;
+	getGridRange(expanded, maxValue, minValue);
+	WorkStealingPool pool(4);
+	ContourContext context, expandedContext;
+	context.canonicalOrder = expandedContext.canonicalOrder = true;
+	vector<float> isovalues, expandedIsovalues;
+	getIsovalues(-12, 12, 1.5f, isovalues);
+	expandedIsovalues = isovalues;
+	doMarchingSquaresAccelerateTask(context, grid, isovalues, 0, 1, 0, 1, maxValue, minValue, &pool);
+	doMarchingSquaresAccelerateTask(expandedContext, expanded, expandedIsovalues, 0, 1, 0, 1, maxValue, minValue, &pool);
+	bool isEqual = hashContour(context) == hashContour(expandedContext);
+	printf("%s storage: %s\n", name, isEqual ? "ok" : "DIFFERENT");
+	return isEqual;
+}
+
+static bool checkStorages(const vector< vector<float> > &data)
+{
+	int rows = data.size(), cols = data[0].size();
+	vector<short> shorts(rows * cols);
+	vector<unsigned short> ushorts(rows * cols);
+	vector<Float16> halfs(rows * cols);
+	vector<float> floats(rows * cols);
+	for (int i = 0; i < rows; ++i)
+	{
+		for (int j = 0; j < cols; ++j)
+		{
+			//按0.5取整，许多格点正好等于等值
+			shorts[i * cols + j] = (short)lrintf(data[i][j] * 2);
+			ushorts[i * cols + j] = (unsigned short)lrintf((data[i][j] + 20) * 2);
+			halfs[i * cols + j].bits = floatToHalf(data[i][j]);
+			floats[i * cols + j] = data[i][j];
+		}
+	}
+	bool isPassed = checkStorage("int16", shorts, rows, cols, 0.5f, 0.0f);
+	isPassed = checkStorage("uint16", ushorts, rows, cols, 0.5f, -20.0f) && isPassed;
+	isPassed = checkStorage("float16", halfs, rows, cols, 1.0f, 0.0f) && isPassed;
+	isPassed = checkStorage("float", floats, rows, cols, 1.0f, 0.0f) && isPassed;
+	return isPassed;
+}
+
+/* 多个等值一起计算（levelNum个等值的特化函数或通用函数）与逐个等值计算（单个等值的特化函数）比较，规范顺序下每个等值的结果相同 */
+static bool checkKernels(const vector< vector<float> > &data)
+{
+	float maxValue, minValue;
+	getGridRange(data, maxValue, minValue);
+	WorkStealingPool pool(4);
+	bool isPassed = true;
+	int levelNums[] = { 7, 10, 13, 20 };
+	for (int n = 0; n < 4; ++n)
+	{
+		vector<float> isovalues(levelNums[n]);
+		for (int m = 0; m < levelNums[n]; ++m)
+		{
+			isovalues[m] = -12 + 24.0f * m / (levelNums[n] - 1);
+		}
+		ContourContext context;
+		context.canonicalOrder = true;
+		doMarchingSquaresAccelerateTask(context, data, isovalues, 0, 1, 0, 1, maxValue, minValue, &pool);
+		bool isEqual = true;
+		for (size_t m = 0; m < isovalues.size(); ++m)
+		{
+			vector<float> single(1, isovalues[m]);
+			ContourContext singleContext;
+			singleContext.canonicalOrder = true;
+			doMarchingSquaresAccelerateTask(singleContext, data, single, 0, 1, 0, 1, maxValue, minValue, &pool);
+			isEqual = isEqual && single.size() == 1 &&
+				hashLevel(0, context.pathLinesV[m]) == hashLevel(0, singleContext.pathLinesV[0]);
+		}
+		printf("%d levels kernel vs single-level kernel: %s\n", (int)isovalues.size(), isEqual ? "ok" : "DIFFERENT");
+		isPassed = isPassed && isEqual;
+	}
+	return isPassed;
+}
+
+int main()
+{
+	vector< vector<float> > data;
+	makeGrid(300, 240, data);
+	bool isPassed = checkThreadCounts(data);
+	isPassed = checkStorages(data) && isPassed;
+	isPassed = checkKernels(data) && isPassed;
+	printf(isPassed ? "PASSED\n" : "FAILED\n");
+	return isPassed ? 0 : 1;
+}
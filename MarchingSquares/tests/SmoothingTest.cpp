@@ -0,0 +1,105 @@
+#include "../MarchingSquares.h"
+#include "../IsolineSmoothing.h"
+#include <cstdio>
+
+using namespace std;
+using namespace marchingsquares;
+
+/************************************************************************/
+/* Author: gcdofree
+ * Date: 2026.10.19
+ * Description: 等值线平滑的检查程序：
+ *	1. 开放的等值线平滑后两个端点不变，所有点的坐标都是有限值，相邻点的间距不超过采样间距太多
+ *	2. 不判断缺测时NaN区域旁生成的坐标为NaN的点保持不变，其余点照常平滑，不能越界访问
+ * 用法: g++ -std=c++11 -O2 -pthread SmoothingTest.cpp ../../CubicSplineInterpolation/CubicInterpolation.cpp -o SmoothingTest && ./SmoothingTest
+/************************************************************************/
+
+static void makeGrid(int rows, int cols, bool withHole, vector< vector<float> > &data)
+{
+	data.assign(rows, vector<float>(cols));
+	for (int i = 0; i < rows; ++i)
+	{
+		for (int j = 0; j < cols; ++j)
+		{
+			data[i][j] = sinf(i * 0.07f) * cosf(j * 0.05f) * 10 + 2 * sinf(i * 0.21f + j * 0.13f);
+			if (withHole && i >= 40 && i < 60 && j >= 30 && j < 50)
+			{
+				data[i][j] = NAN;
+			}
+		}
+	}
+}
+
+static int countNonFinite(const isotools::Isoline &line)
+{
+	int count = 0;
+	for (list<isotools::Point2D>::const_iterator it = line.points.begin(); it != line.points.end(); ++it)
+	{
+		count += std::isfinite(it->x) && std::isfinite(it->y) ? 0 : 1;
+	}
+	return count;
+}
+
+static bool checkSmoothing(bool withHole)
+{
+	vector< vector<float> > data;
+	makeGrid(120, 100, withHole, data);
+	vector<float> isovalues;
+	for (float value = -10; value <= 10; value += 2.5f)
+	{
+		isovalues.push_back(value);
+	}
+	//options为NULL：不判断缺测，NaN格点旁的交点坐标为NaN
+	vector< vector<isotools::Isoline>> pathLinesV;
+	doMarchingSquaresAccelerateTask(data, isovalues, pathLinesV, 0, 1, 0, 1, 13, -13);
+	vector< vector<isotools::Isoline>> original = pathLinesV;
+
+	const float spacing = 0.4f;
+	smoothIsolines(pathLinesV, spacing);
+
+	int badEnds = 0, badPoints = 0, badGaps = 0, nanLines = 0;
+	for (size_t m = 0; m < pathLinesV.size(); ++m)
+	{
+		for (size_t k = 0; k < pathLinesV[m].size(); ++k)
+		{
+			const isotools::Isoline &before = original[m][k];
+			const isotools::Isoline &after = pathLinesV[m][k];
+			int nonFinite = countNonFinite(before);
+			nanLines += nonFinite > 0 ? 1 : 0;
+			if (countNonFinite(after) > nonFinite)
+			{
+				++badPoints;
+			}
+			if (nonFinite > 0)
+			{
+				continue;
+			}
+			if (!before.isCircle && before.points.size() >= 3 &&
+				(!(after.points.front() == before.points.front()) || !(after.points.back() == before.points.back())))
+			{
+				++badEnds;
+			}
+			list<isotools::Point2D>::const_iterator it = after.points.begin(), prev = it;
+			for (++it; it != after.points.end() && before.points.size() >= 3; prev = it, ++it)
+			{
+				if (hypot(it->x - prev->x, it->y - prev->y) > spacing * 1.5f)
+				{
+					++badGaps;
+					break;
+				}
+			}
+		}
+	}
+	bool isPassed = badEnds == 0 && badPoints == 0 && badGaps == 0 && (!withHole || nanLines > 0);
+	printf("hole %d: lines with NaN points %d, bad ends %d, bad points %d, bad gaps %d: %s\n", withHole ? 1 : 0,
+		nanLines, badEnds, badPoints, badGaps, isPassed ? "ok" : "FAILED");
+	return isPassed;
+}
+
+int main()
+{
+	bool isPassed = checkSmoothing(false);
+	isPassed = checkSmoothing(true) && isPassed;
+	printf(isPassed ? "PASSED\n" : "FAILED\n");
+	return isPassed ? 0 : 1;
+}